@@ -0,0 +1,335 @@
+// unrolled_list test program.
+// Checks every operation of unrolled_list against std::list, at every
+// position of lists that span from none to several nodes.
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdlib>
+#include <ctime>
+#include <list>
+#include "unrolled_list-1111514-hw6.h" // include definition of class template unrolled_list
+
+template< typename T >
+void testList();
+
+template< typename T >
+void testFillConstructor();
+
+template< typename T >
+void testCopyConstructor();
+
+template< typename T >
+void testAssignment();
+
+template< typename T >
+void testInsert();
+
+template< typename T >
+void testErase();
+
+template< typename T >
+void testEraseAll();
+
+template< typename T >
+void testClear();
+
+// gives the elements of list1 and list2, which have the same size,
+// the same random values
+template< typename T >
+void randomize( unrolled_list< T > &list1, std::list< T > &list2 );
+
+// return true iff left == right, walking both forward and backward,
+// and the nodes of left are neither empty nor over capacity
+template< typename T >
+bool equal( unrolled_list< T > &left, std::list< T > &right );
+
+int main()
+{
+   srand( static_cast< unsigned int >( time( 0 ) ) );
+
+   testList< char >();
+   testList< short >();
+   testList< long >();
+   testList< long long >();
+
+   system( "pause" );
+}
+
+template< typename T >
+void testList()
+{
+   testFillConstructor< T >();
+   testCopyConstructor< T >();
+   testAssignment< T >();
+   testInsert< T >();
+   testErase< T >();
+   testEraseAll< T >();
+   testClear< T >();
+   cout << endl;
+}
+
+const int number = 500;
+
+template< typename T >
+void testFillConstructor()
+{
+   int numErrors = 0;
+   for( int n = 0; n < number; n++ )
+   {
+      unrolled_list< T > list1( n );
+      std::list< T > list2( n );
+
+      if( !equal( list1, list2 ) )
+         numErrors++;
+
+      randomize( list1, list2 );
+
+      if( !equal( list1, list2 ) )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n";
+}
+
+template< typename T >
+void testCopyConstructor()
+{
+   int numErrors = 0;
+   for( int n = 0; n < number; n++ )
+   {
+      unrolled_list< T > list1( n );
+      std::list< T > list2( n );
+      randomize( list1, list2 );
+
+      unrolled_list< T > list3( list1 );
+      std::list< T > list4( list2 );
+
+      if( !equal( list3, list4 ) || !equal( list1, list2 ) )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n";
+}
+
+template< typename T >
+void testAssignment()
+{
+   const int number = 100;
+   int numErrors = 0;
+   for( int n1 = 0; n1 < number; n1++ )
+   {
+      unrolled_list< T > list1( n1 );
+      std::list< T > list2( n1 );
+      randomize( list1, list2 );
+
+      for( int n2 = 0; n2 < number; n2++ )
+      {
+         unrolled_list< T > list3( n2 );
+         std::list< T > list4( n2 );
+         randomize( list3, list4 );
+
+         list3 = list1;
+         list4 = list2;
+
+         if( !equal( list3, list4 ) || !equal( list1, list2 ) )
+            numErrors++;
+      }
+
+      // self-assignment leaves the list as it was
+      unrolled_list< T > &self = list1;
+      list1 = self;
+      if( !equal( list1, list2 ) )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n";
+}
+
+template< typename T >
+void testInsert()
+{
+   const int number = 100;
+   int numErrors = 0;
+   for( int n = 0; n < number; n++ )
+      for( int position = 0; position <= n; position++ )
+      {
+         unrolled_list< T > list1( n );
+         std::list< T > list2( n );
+         randomize( list1, list2 );
+
+         typename unrolled_list< T >::iterator it1 = list1.begin();
+         typename std::list< T >::iterator it2 = list2.begin();
+         for( int i = 0; i < position; i++ )
+         {
+            ++it1;
+            ++it2;
+         }
+
+         T value = 1 + rand() % 99;
+         it1 = list1.insert( it1, value );
+         it2 = list2.insert( it2, value );
+
+         // the iterator returned refers to the new element
+         if( *it1 != value || ( ++it1 != list1.end() && *it1 != *++it2 ) )
+            numErrors++;
+         else if( !equal( list1, list2 ) )
+            numErrors++;
+      }
+
+   cout << "There are " << numErrors << " errors\n";
+}
+
+template< typename T >
+void testErase()
+{
+   const int number = 100;
+   int numErrors = 0;
+   for( int n = 0; n < number; n++ )
+      for( int position = 0; position < n; position++ )
+      {
+         unrolled_list< T > list1( n );
+         std::list< T > list2( n );
+         randomize( list1, list2 );
+
+         typename unrolled_list< T >::iterator it1 = list1.begin();
+         typename std::list< T >::iterator it2 = list2.begin();
+         for( int i = 0; i < position; i++ )
+         {
+            ++it1;
+            ++it2;
+         }
+
+         it1 = list1.erase( it1 );
+         it2 = list2.erase( it2 );
+
+         // the iterator returned refers to the element that followed
+         if( ( it1 == list1.end() ) != ( it2 == list2.end() ) || ( it2 != list2.end() && *it1 != *it2 ) )
+            numErrors++;
+         else if( !equal( list1, list2 ) )
+            numErrors++;
+      }
+
+   cout << "There are " << numErrors << " errors\n";
+}
+
+// erases elements at random positions until the list is empty, so that
+// nodes are refilled from and merged with their neighbours
+template< typename T >
+void testEraseAll()
+{
+   int numErrors = 0;
+   for( int n = 0; n < number; n++ )
+   {
+      unrolled_list< T > list1( n );
+      std::list< T > list2( n );
+      randomize( list1, list2 );
+
+      for( int size = n; size > 0; size-- )
+      {
+         int position = rand() % size;
+         typename unrolled_list< T >::iterator it1 = list1.begin();
+         typename std::list< T >::iterator it2 = list2.begin();
+         for( int i = 0; i < position; i++ )
+         {
+            ++it1;
+            ++it2;
+         }
+
+         list1.erase( it1 );
+         list2.erase( it2 );
+
+         if( !equal( list1, list2 ) )
+         {
+            numErrors++;
+            break;
+         }
+      }
+   }
+
+   cout << "There are " << numErrors << " errors\n";
+}
+
+template< typename T >
+void testClear()
+{
+   int numErrors = 0;
+   for( int n = 0; n < number; n++ )
+   {
+      unrolled_list< T > list1( n );
+      std::list< T > list2( n );
+      randomize( list1, list2 );
+
+      list1.clear();
+      list2.clear();
+      if( !equal( list1, list2 ) )
+         numErrors++;
+
+      // the list is usable again after clear
+      for( int i = 0; i < n; i++ )
+      {
+         T value = 1 + rand() % 99;
+         list1.insert( list1.end(), value );
+         list2.insert( list2.end(), value );
+      }
+      if( !equal( list1, list2 ) )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n";
+}
+
+// gives the elements of list1 and list2, which have the same size,
+// the same random values
+template< typename T >
+void randomize( unrolled_list< T > &list1, std::list< T > &list2 )
+{
+   typename unrolled_list< T >::iterator it1 = list1.begin();
+   typename std::list< T >::iterator it2 = list2.begin();
+   for( ; it2 != list2.end(); ++it1, ++it2 )
+   {
+      T value = 1 + rand() % 99;
+      *it1 = value;
+      *it2 = value;
+   }
+}
+
+// return true iff left == right, walking both forward and backward,
+// and the nodes of left are neither empty nor over capacity
+template< typename T >
+bool equal( unrolled_list< T > &left, std::list< T > &right )
+{
+   if( left.size() != right.size() ) // different number of elements
+      return false;
+
+   if( left.empty() != ( left.begin() == left.end() ) )
+      return false;
+
+   size_t count = 0;
+   typename unrolled_list< T >::iterator it1 = left.begin();
+   for( ; it1.myNode != left.end().myNode; it1.myNode = it1.myNode->next )
+   {
+      if( it1.myNode->myCount == 0 || it1.myNode->myCount > UnrolledListNode< T >::capacity )
+         return false;
+      count += it1.myNode->myCount;
+   }
+   if( count != left.size() )
+      return false;
+
+   if( right.size() == 0 )
+      return true;
+
+   it1 = left.begin();
+   typename std::list< T >::iterator it2 = right.begin();
+   for( ; it2 != right.end(); ++it1, ++it2 )
+      if( *it1 != *it2 )
+         return false;
+   if( it1 != left.end() )
+      return false;
+
+   for( ; it2 != right.begin(); )
+      if( *--it1 != *--it2 )
+         return false;
+
+   return left.front() == right.front() && left.back() == right.back();
+}
\ No newline at end of file
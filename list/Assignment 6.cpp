@@ -32,6 +32,11 @@ void testInsert();
 template< typename T >
 void testErase();
 
+// checks that the copy of a list whose nodes come from a shared pool has
+// its nodes next to one another, in order
+template< typename T >
+void testSharedPoolCopy();
+
 // return true iff left == right
 template< typename T >
 bool equal( list< T > &left, std::list< T > &right );
@@ -57,6 +62,7 @@ void testList()
    testAssignment2< T >();
    testInsert< T >();
    testErase< T >();
+   testSharedPoolCopy< T >();
    cout << endl;
 }
 
@@ -344,6 +350,37 @@ void testErase()
    cout << "There are " << numErrors << " errors\n";
 }
 
+// the copy of a list whose nodes come from a shared pool has its nodes
+// next to one another, in order, even if the pool has unused nodes left
+template< typename T >
+void testSharedPoolCopy()
+{
+   const int number = 300;
+   int numErrors = 0;
+   for( int n = 1; n <= number; n++ )
+   {
+      ListNodePool< T > pool;
+      list< T > list1( pool );
+      list< T > list2( pool );
+      for( int i = 0; i < 20; i++ )
+         list1.insert( list1.end(), 1 + rand() % 99 );
+      for( int i = 0; i < n; i++ )
+         list2.insert( list2.end(), 1 + rand() % 99 );
+
+      list< T > list3( list2 );
+
+      typename list< T >::iterator p = list3.begin();
+      for( ; p->next != list3.end(); p = p->next )
+         if( p->next != p + 1 )
+            break;
+
+      if( p->next != list3.end() || list3.size() != list2.size() )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors\n";
+}
+
 // return true iff left == right
 template< typename T >
 bool equal( list< T > &left, std::list< T > &right )
@@ -3,6 +3,9 @@
 #ifndef LIST
 #define LIST
 
+#include <cstdlib>
+#include <iostream>
+
 template< typename ValueType >
 struct ListNode // list node
 {
@@ -12,6 +15,108 @@ struct ListNode // list node
 };
 
 
+// CLASS TEMPLATE ListNodePool
+// Allocates list nodes from slabs, arrays of many nodes each, so that the
+// nodes of a list lie next to one another instead of across the heap.
+// The unused nodes of the newest slab are handed out first, in order of
+// address; erased nodes go on a free list and are handed out again once that
+// slab is used up. The slabs are deleted only with the pool, and no slab is
+// allocated before the first node is. A pool may be shared by several lists of one thread, and must
+// outlive them.
+template< typename Ty >
+class ListNodePool
+{
+public:
+   using node = ListNode< Ty >;
+   using nodePtr = node *;
+
+   ListNodePool()
+      : slabs( nullptr ),
+        freeList( nullptr ),
+        current( nullptr ),
+        remaining( 0 ),
+        nextSlabSize( minSlabSize )
+   {
+   }
+
+   ListNodePool( const ListNodePool & ) = delete;
+   ListNodePool& operator=( const ListNodePool & ) = delete;
+
+   // Deletes all slabs, with every node ever allocated from them
+   ~ListNodePool()
+   {
+      while( slabs != nullptr )
+      {
+         nodePtr previous = slabs->next;
+         delete[] slabs;
+         slabs = previous;
+      }
+   }
+
+   // Makes sure that the next "count" nodes come from one slab, in order of
+   // address; a new slab is started if the newest has fewer unused nodes
+   void reserve( size_t count )
+   {
+      if( remaining < count )
+         newSlab( count );
+   }
+
+   // Returns a node, whose links are not set
+   nodePtr allocate()
+   {
+      if( remaining == 0 )
+      {
+         if( freeList != nullptr )
+         {
+            nodePtr p = freeList;
+            freeList = p->next;
+            return p;
+         }
+
+         newSlab( nextSlabSize );
+         if( nextSlabSize < maxSlabSize )
+            nextSlabSize *= 2;
+      }
+
+      remaining--;
+      return current++;
+   }
+
+   // Takes back a node returned by allocate; its value is reset to Ty(), so
+   // that whatever the element held is released now rather than with the slab
+   void deallocate( nodePtr p )
+   {
+      p->myVal = Ty();
+      p->next = freeList;
+      freeList = p;
+   }
+
+private:
+   static const size_t minSlabSize = 16;   // nodes in the first slab
+   static const size_t maxSlabSize = 4096; // slabs double in size up to this
+
+   nodePtr slabs;       // the newest slab; node 0 of a slab links to the slab before
+   nodePtr freeList;    // the freed nodes, linked by next
+   nodePtr current;     // the first unused node of the newest slab
+   size_t remaining;    // the number of unused nodes from current on
+   size_t nextSlabSize; // the number of nodes in the next slab allocate() needs
+
+   // Starts a slab of "count" nodes; the unused nodes of the last one are
+   // freed, to be handed out after the new slab
+   void newSlab( size_t count )
+   {
+      for( ; remaining > 0; remaining-- )
+         deallocate( current++ );
+
+      nodePtr slab = new node[ count + 1 ];
+      slab->next = slabs;
+      slabs = slab;
+      current = slab + 1;
+      remaining = count;
+   }
+};
+
+
 // CLASS TEMPLATE ListVal
 template< typename Ty >
 class ListVal
@@ -62,67 +167,67 @@ public:
    // empty container constructor (default constructor)
    // Constructs an empty container, with no elements.
    list()
-      : myData()
+      : myData(),
+        myPool( nullptr ),
+        ownsPool( true )
    {
-      myData.myHead = new node;
-      myData.myHead->myVal = Ty();
-      myData.myHead->prev = myData.myHead->next = myData.myHead;
+      makeHead();
+   }
+
+   // Constructs an empty container whose nodes come from "pool", which may
+   // be shared with other lists and must outlive the list.
+   explicit list( ListNodePool< Ty > &pool )
+      : myData(),
+        myPool( &pool ),
+        ownsPool( false )
+   {
+      makeHead();
    }
 
    // fill constructor
    // Constructs a container with "count" elements.
    // Each element is initialized as 0.
    list( size_type count ) // construct list from count * Ty()
-      : myData()
+      : myData(),
+        myPool( nullptr ),
+        ownsPool( true )
    {
-      myData.myHead = new node;
-      myData.myHead->myVal = Ty();
-      myData.myHead->prev = myData.myHead->next = myData.myHead;
-      nodePtr t = myData.myHead;
-      for (int i = 0; i < count; i++) {
-          nodePtr tmp = new node;
-          tmp->myVal = Ty();
-          tmp->prev = t;
-          t->next = tmp;
-          tmp->next = myData.myHead;
-          myData.myHead->prev = tmp;
-          t=t->next;
-      }
-      myData.mySize = count;
+      makeHead();
+
+      // all elements lie in one slab, in order
+      if( count > 0 )
+         pool().reserve( count );
+      for( size_type i = 0; i < count; i++ )
+         linkBefore( myData.myHead, Ty() );
    }
 
    // copy constructor
    // Constructs a container with a copy of each of the elements in "right",
    // in the same order.
+   // A copy of a list with a shared pool shares that pool too.
    list( const list &right )
-      : myData()
+      : myData(),
+        myPool( right.ownsPool ? nullptr : right.myPool ),
+        ownsPool( right.ownsPool )
    {
-       
-       myData.myHead = new node;
-       myData.myHead->myVal = Ty();
-       myData.myHead->prev = myData.myHead->next = myData.myHead;
-       nodePtr t = myData.myHead;
-       nodePtr s = right.myData.myHead->next;
-       for (int i = 0; i < right.myData.mySize; i++) {
-           nodePtr tmp = new node;
-           tmp->myVal = Ty();
-           tmp->prev = t;
-           t->next = tmp;
-           tmp->next = myData.myHead;
-           myData.myHead->prev = tmp;
-           tmp->myVal = s->myVal;
-           t = t->next;
-           s = s->next;
-       }
-       myData.mySize = right.myData.mySize;
+      makeHead();
+
+      if( right.myData.mySize > 0 )
+         pool().reserve( right.myData.mySize );
+      for( nodePtr s = right.myData.myHead->next; s != right.myData.myHead; s = s->next )
+         linkBefore( myData.myHead, s->myVal );
    }
 
    // List destructor
    // Destroys the container object.
-   // Deallocates all the storage capacity allocated by the list container.
+   // Deallocates all the storage capacity allocated by the list container;
+   // a pool of its own goes with all its slabs at once.
    ~list()
    {
-      clear();
+      if( ownsPool )
+         delete myPool;
+      else
+         clear();
       delete myData.myHead;
    }
 
@@ -134,52 +239,23 @@ public:
    {
       if( this != &right )
       {
-          
-          if (right.myData.mySize == myData.mySize) {
-              nodePtr x = myData.myHead->next;
-              nodePtr y = right.myData.myHead->next;
-              for (int i = 0; i < right.myData.mySize; i++) {
-                  x->myVal = y->myVal;
-                  x = x->next;
-                  y = y->next;
-              }
-          }
-          else if (right.myData.mySize > myData.mySize) {
-              size_type count = right.myData.mySize - myData.mySize;
-              nodePtr t = myData.myHead->prev;
-              //expand the size 
-              for (int i = 0; i < count; i++) {
-                  nodePtr tmp = new node;
-                  tmp->myVal = Ty();
-                  tmp->prev = t;
-                  t->next = tmp;
-                  tmp->next = myData.myHead;
-                  myData.myHead->prev = tmp;
-                  t = t->next;
-              }
-              nodePtr x = myData.myHead->next;
-              nodePtr y = right.myData.myHead->next;
-              for (int i = 0; i < right.myData.mySize; i++) {
-                  x->myVal = y->myVal;
-                  x = x->next;
-                  y = y->next;
-              }
-              myData.mySize = right.myData.mySize;
-          }
-          else {
-              nodePtr x = myData.myHead->next;
-              nodePtr y = right.myData.myHead->next;
-              for (int i = 0; i < myData.mySize; i++) {
-                  x->myVal = y->myVal;
-                  x = x->next;
-                  y = y->next;
-              }
-              nodePtr del = x->prev;
-              myData.myHead->prev = x;
-              del->next = myData.myHead;
-            
-              myData.mySize = right.myData.mySize;
-          }
+         // the nodes already in the list keep their places
+         nodePtr x = myData.myHead->next;
+         nodePtr y = right.myData.myHead->next;
+         for( ; x != myData.myHead && y != right.myData.myHead; x = x->next, y = y->next )
+            x->myVal = y->myVal;
+
+         // "right" is longer: append the rest of its elements
+         for( ; y != right.myData.myHead; y = y->next )
+            linkBefore( myData.myHead, y->myVal );
+
+         // "right" is shorter: return the nodes left over to the pool
+         while( x != myData.myHead )
+         {
+            nodePtr next = x->next;
+            unlink( x );
+            x = next;
+         }
       }
       return *this;
    }
@@ -262,59 +338,119 @@ public:
    // before the element at the specified position.
    // This effectively increases the list size by the amount of elements inserted.
    // Returns an iterator that points to the newly inserted element.
+   // Takes constant time; "where" must be an iterator of this list.
    iterator insert( const_iterator where, const Ty &val ) // insert val at where
    {
-       
-       nodePtr n = new node;
-       n->myVal = val;
-       n->prev = n->next = n;
-       nodePtr a = myData.myHead;
-       while (a != where) {
-           a = a->next;
-       }
-       nodePtr b = a->prev;
-       a->prev = n;
-       n->next = a;
-       b->next = n;
-       n->prev = b;
-       myData.mySize++;
-       return iterator(where);
+#ifdef _DEBUG
+      checkOwner( where, "list insert iterator outside range\n" );
+#endif
+      return iterator( linkBefore( const_cast< nodePtr >( where ), val ) );
    }
 
    // Removes from the list container the element at the specified position.
-   // This effectively reduces the container size one, which is destroyed.
+   // This effectively reduces the container size one; the element's node
+   // goes back to the pool, holding Ty() in place of the element.
    // Returns an iterator pointing to the element that followed the element erased.
    // This is the container end if the operation erased the last element in the sequence.
+   // Takes constant time; "where" must be a dereferenceable iterator of this list.
    iterator erase( const_iterator where )
    {
-       nodePtr x = myData.myHead;
-       while (x != where) {
-           x = x->next;
-       }
-       nodePtr f = x->next;
-       nodePtr b = x->prev;
-       b->next = f;
-       f->prev = b;
-
-       myData.mySize--;
-       return iterator(where);
+#ifdef _DEBUG
+      if( where == myData.myHead )
+      {
+         std::cout << "list erase iterator outside range\n";
+         std::exit( 1 );
+      }
+      checkOwner( where, "list erase iterator outside range\n" );
+#endif
+      nodePtr next = where->next;
+      unlink( const_cast< nodePtr >( where ) );
+      return iterator( next );
    }
 
-   // Removes all elements from the list container (which are destroyed),
-   // and leaving the container with a size of 0.
+   // Removes all elements from the list container (their nodes go back to
+   // the pool, holding Ty()), and leaving the container with a size of 0.
    void clear() // erase all
    {
       if( myData.mySize != 0 ) // the list is not empty
       {
-          delete myData.myHead->next;
-          myData.myHead->next = myData.myHead;
-          myData.myHead->prev = myData.myHead;
-          myData.mySize = 0;
+         // every node goes back to the pool, not only the first
+         nodePtr x = myData.myHead->next;
+         while( x != myData.myHead )
+         {
+            nodePtr next = x->next;
+            myPool->deallocate( x );
+            x = next;
+         }
+
+         myData.myHead->next = myData.myHead;
+         myData.myHead->prev = myData.myHead;
+         myData.mySize = 0;
       }
    }
 
 private:
-   ScaryVal myData;
+   ScaryVal myData;            // first, where the tests expect the head pointer
+   ListNodePool< Ty > *myPool; // where the nodes come from; null until a list of its own needs one
+   bool ownsPool;              // true if myPool is the list's own, deleted with it
+
+   // Allocates the head node, linked to itself; it is not taken from the
+   // pool, so that an empty list allocates no slab
+   void makeHead()
+   {
+      myData.myHead = new node;
+      myData.myHead->myVal = Ty();
+      myData.myHead->prev = myData.myHead->next = myData.myHead;
+   }
+
+   // Returns the pool, creating the list's own on first use
+   ListNodePool< Ty >& pool()
+   {
+      if( myPool == nullptr )
+         myPool = new ListNodePool< Ty >;
+      return *myPool;
+   }
+
+   // Takes a node from the pool holding "val" and links it in before "where"
+   nodePtr linkBefore( nodePtr where, const Ty &val )
+   {
+      nodePtr n = pool().allocate();
+      n->myVal = val;
+      n->next = where;
+      n->prev = where->prev;
+      where->prev->next = n;
+      where->prev = n;
+      myData.mySize++;
+      return n;
+   }
+
+   // Unlinks the element "where" and returns its node to the pool
+   void unlink( nodePtr where )
+   {
+      where->prev->next = where->next;
+      where->next->prev = where->prev;
+      myPool->deallocate( where );
+      myData.mySize--;
+   }
+
+#ifdef _DEBUG
+   // Walks the list to make sure "where" is one of its nodes, head included;
+   // prints "message" and exits if it is not. Debug builds only, since it
+   // makes insert and erase linear again.
+   void checkOwner( const_iterator where, const char *message ) const
+   {
+      nodePtr x = myData.myHead;
+      while( x != where )
+      {
+         x = x->next;
+         if( x == myData.myHead )
+         {
+            std::cout << message;
+            std::exit( 1 );
+         }
+      }
+   }
+#endif
 };
 
 // determine if two lists are equal and return true, otherwise return false
@@ -0,0 +1,593 @@
+// unrolled_list header
+// A doubly linked list that keeps up to a cache line of elements in each
+// node instead of one. For small elements such as char or short, a list node
+// spends most of its bytes on its two links, and iteration follows a link
+// per element; an unrolled list follows one per node.
+//
+// A full node is split in two on insert, and a node less than half full is
+// refilled from, or merged with, a neighbour on erase. Elements therefore
+// move between nodes: insert and erase invalidate the iterators to the
+// elements of the nodes they touch (the node of "where" and, on a split or
+// merge, its neighbour), but every other iterator stays valid.
+
+#ifndef UNROLLED_LIST
+#define UNROLLED_LIST
+
+#include <cstddef>
+#include <iterator>
+
+// The number of bytes of elements in an unrolled list node
+const size_t UnrolledLineSize = 64;
+
+template< typename ValueType >
+struct UnrolledListNode // unrolled list node
+{
+   // elements per node: a cache line of them, but at least two, so that a
+   // full node can be split into two nodes that are not full
+   static const size_t capacity =
+      UnrolledLineSize / sizeof( ValueType ) > 2 ? UnrolledLineSize / sizeof( ValueType ) : 2;
+
+   UnrolledListNode *next; // successor node, or first node if head
+   UnrolledListNode *prev; // predecessor node, or last node if head
+   size_t myCount;         // the number of elements in use, 0 if head
+   ValueType myVals[ capacity ]; // the stored values, in order
+};
+
+
+// CLASS TEMPLATE UnrolledListConstIterator
+// Refers to element myIndex of node myNode; end() is index 0 of the head.
+template< typename Ty >
+class UnrolledListConstIterator
+{
+public:
+   using node = UnrolledListNode< Ty >;
+   using nodePtr = node *;
+
+   using iterator_category = std::bidirectional_iterator_tag;
+   using value_type = Ty;
+   using difference_type = ptrdiff_t;
+   using pointer = const value_type *;
+   using reference = const value_type &;
+
+   UnrolledListConstIterator()
+      : myNode( nullptr ),
+        myIndex( 0 )
+   {
+   }
+
+   UnrolledListConstIterator( nodePtr where, size_t index )
+      : myNode( where ),
+        myIndex( index )
+   {
+   }
+
+   reference operator*() const
+   {
+      return myNode->myVals[ myIndex ];
+   }
+
+   pointer operator->() const
+   {
+      return myNode->myVals + myIndex;
+   }
+
+   // Moves to the next element, which is the first of the next node after
+   // the last of a node
+   UnrolledListConstIterator& operator++()
+   {
+      if( ++myIndex == myNode->myCount )
+      {
+         myNode = myNode->next;
+         myIndex = 0;
+      }
+      return *this;
+   }
+
+   UnrolledListConstIterator operator++( int )
+   {
+      UnrolledListConstIterator temp = *this;
+      ++*this;
+      return temp;
+   }
+
+   // Moves to the previous element; from end(), to the last element
+   UnrolledListConstIterator& operator--()
+   {
+      if( myIndex == 0 )
+      {
+         myNode = myNode->prev;
+         myIndex = myNode->myCount;
+      }
+      --myIndex;
+      return *this;
+   }
+
+   UnrolledListConstIterator operator--( int )
+   {
+      UnrolledListConstIterator temp = *this;
+      --*this;
+      return temp;
+   }
+
+   bool operator==( const UnrolledListConstIterator &right ) const
+   {
+      return myNode == right.myNode && myIndex == right.myIndex;
+   }
+
+   bool operator!=( const UnrolledListConstIterator &right ) const
+   {
+      return !( *this == right );
+   }
+
+   nodePtr myNode;  // the node holding the element
+   size_t myIndex;  // the position of the element in myNode->myVals
+};
+
+
+// CLASS TEMPLATE UnrolledListIterator
+template< typename Ty >
+class UnrolledListIterator : public UnrolledListConstIterator< Ty >
+{
+public:
+   using MyBase = UnrolledListConstIterator< Ty >;
+   using nodePtr = typename MyBase::nodePtr;
+
+   using iterator_category = std::bidirectional_iterator_tag;
+   using value_type = Ty;
+   using difference_type = ptrdiff_t;
+   using pointer = value_type *;
+   using reference = value_type &;
+
+   UnrolledListIterator()
+   {
+   }
+
+   UnrolledListIterator( nodePtr where, size_t index )
+      : MyBase( where, index )
+   {
+   }
+
+   reference operator*() const
+   {
+      return const_cast< reference >( MyBase::operator*() );
+   }
+
+   pointer operator->() const
+   {
+      return const_cast< pointer >( MyBase::operator->() );
+   }
+
+   UnrolledListIterator& operator++()
+   {
+      MyBase::operator++();
+      return *this;
+   }
+
+   UnrolledListIterator operator++( int )
+   {
+      UnrolledListIterator temp = *this;
+      MyBase::operator++();
+      return temp;
+   }
+
+   UnrolledListIterator& operator--()
+   {
+      MyBase::operator--();
+      return *this;
+   }
+
+   UnrolledListIterator operator--( int )
+   {
+      UnrolledListIterator temp = *this;
+      MyBase::operator--();
+      return temp;
+   }
+};
+
+
+// CLASS TEMPLATE UnrolledListVal
+template< typename Ty >
+class UnrolledListVal
+{
+public:
+   using node = UnrolledListNode< Ty >;
+   using nodePtr = node *;
+
+   using value_type = Ty;
+   using size_type = size_t;
+   using difference_type = ptrdiff_t;
+   using pointer = value_type *;
+   using const_pointer = const value_type *;
+   using reference = value_type &;
+   using const_reference = const value_type &;
+
+   UnrolledListVal() // initialize data
+      : myHead(),
+        mySize( 0 )
+   {
+   }
+
+   nodePtr myHead; // pointer to head node
+   size_type mySize; // number of elements
+};
+
+
+// CLASS TEMPLATE unrolled_list
+template< typename Ty >
+class unrolled_list // bidirectional linked list of arrays of elements
+{
+   using node = UnrolledListNode< Ty >;
+   using nodePtr = node *;
+   using ScaryVal = UnrolledListVal< Ty >;
+
+   static const size_t capacity = node::capacity;
+
+public:
+   using value_type = Ty;
+   using size_type = size_t;
+   using difference_type = ptrdiff_t;
+   using pointer = value_type *;
+   using const_pointer = const value_type *;
+   using reference = value_type &;
+   using const_reference = const value_type &;
+
+   using iterator = UnrolledListIterator< Ty >;
+   using const_iterator = UnrolledListConstIterator< Ty >;
+
+   // empty container constructor (default constructor)
+   // Constructs an empty container, with no elements.
+   unrolled_list()
+      : myData()
+   {
+      makeHead();
+   }
+
+   // fill constructor
+   // Constructs a container with "count" elements.
+   // Each element is initialized as 0.
+   unrolled_list( size_type count ) // construct list from count * Ty()
+      : myData()
+   {
+      makeHead();
+      for( size_type i = 0; i < count; i += capacity )
+      {
+         nodePtr n = linkNodeBefore( myData.myHead );
+         n->myCount = count - i < capacity ? count - i : capacity;
+         for( size_type k = 0; k < n->myCount; k++ )
+            n->myVals[ k ] = Ty();
+      }
+      myData.mySize = count;
+   }
+
+   // copy constructor
+   // Constructs a container with a copy of each of the elements in "right",
+   // in the same order, with every node full but the last.
+   unrolled_list( const unrolled_list &right )
+      : myData()
+   {
+      makeHead();
+      *this = right;
+   }
+
+   // List destructor
+   // Destroys the container object.
+   // Deallocates all the storage capacity allocated by the list container.
+   ~unrolled_list()
+   {
+      clear();
+      delete myData.myHead;
+   }
+
+   // Assigns new contents to the container, replacing its current contents,
+   // and modifying its size accordingly.
+   // Copies all the elements from "right" into the container, filling the
+   // nodes it already has before allocating more, and deleting those left over.
+   unrolled_list& operator=( const unrolled_list &right )
+   {
+      if( this != &right )
+      {
+         nodePtr x = myData.myHead->next;
+         const_iterator y = right.begin();
+         const_iterator last = right.end();
+         while( y != last )
+         {
+            if( x == myData.myHead )
+               x = linkNodeBefore( myData.myHead );
+
+            x->myCount = 0;
+            for( ; x->myCount < capacity && y != last; ++y )
+               x->myVals[ x->myCount++ ] = *y;
+            x = x->next;
+         }
+
+         while( x != myData.myHead )
+         {
+            nodePtr next = x->next;
+            unlinkNode( x );
+            x = next;
+         }
+
+         myData.mySize = right.myData.mySize;
+      }
+      return *this;
+   }
+
+   // Returns an iterator pointing to the first element in the list container.
+   // If the container is empty, the returned iterator value shall not be dereferenced.
+   iterator begin()
+   {
+      return iterator( myData.myHead->next, 0 );
+   }
+
+   // Returns an iterator pointing to the first element in the list container.
+   // If the container is empty, the returned iterator value shall not be dereferenced.
+   const_iterator begin() const
+   {
+      return const_iterator( myData.myHead->next, 0 );
+   }
+
+   // Returns an iterator referring to the past-the-end element in the list container.
+   // It does not point to any element, and thus shall not be dereferenced.
+   // If the container is empty, this function returns the same as unrolled_list::begin.
+   iterator end()
+   {
+      return iterator( myData.myHead, 0 );
+   }
+
+   // Returns an iterator referring to the past-the-end element in the list container.
+   // It does not point to any element, and thus shall not be dereferenced.
+   // If the container is empty, this function returns the same as unrolled_list::begin.
+   const_iterator end() const
+   {
+      return const_iterator( myData.myHead, 0 );
+   }
+
+   // Returns the number of elements in the list container.
+   size_type size() const
+   {
+      return myData.mySize;
+   }
+
+   // Returns whether the list container is empty (i.e. whether its size is 0).
+   bool empty() const
+   {
+      return myData.mySize == 0;
+   }
+
+   // Returns a reference to the first element in the list container.
+   // Calling this function on an empty container causes undefined behavior.
+   reference front()
+   {
+      return myData.myHead->next->myVals[ 0 ];
+   }
+
+   // Returns a reference to the first element in the list container.
+   // Calling this function on an empty container causes undefined behavior.
+   const_reference front() const
+   {
+      return myData.myHead->next->myVals[ 0 ];
+   }
+
+   // Returns a reference to the last element in the list container.
+   // Calling this function on an empty container causes undefined behavior.
+   reference back()
+   {
+      nodePtr last = myData.myHead->prev;
+      return last->myVals[ last->myCount - 1 ];
+   }
+
+   // Returns a reference to the last element in the list container.
+   // Calling this function on an empty container causes undefined behavior.
+   const_reference back() const
+   {
+      nodePtr last = myData.myHead->prev;
+      return last->myVals[ last->myCount - 1 ];
+   }
+
+   // The container is extended by inserting a new element
+   // before the element at the specified position.
+   // Returns an iterator that points to the newly inserted element.
+   // Takes time proportional to the capacity of a node, not to the size.
+   iterator insert( const_iterator where, const Ty &val ) // insert val at where
+   {
+      nodePtr n = where.myNode;
+      size_type index = where.myIndex;
+
+      // before end(), the element goes at the back of the last node
+      if( n == myData.myHead )
+      {
+         n = n->prev;
+         index = n->myCount;
+         if( n == myData.myHead || n->myCount == capacity )
+         {
+            n = linkNodeBefore( myData.myHead );
+            index = 0;
+         }
+      }
+      else if( n->myCount == capacity )
+      {
+         // split: the upper half of n moves to a new node after it
+         nodePtr upper = linkNodeBefore( n->next );
+         size_type keep = capacity / 2;
+         for( size_type k = keep; k < capacity; k++ )
+            upper->myVals[ k - keep ] = n->myVals[ k ];
+         upper->myCount = capacity - keep;
+         n->myCount = keep;
+
+         if( index > keep )
+         {
+            n = upper;
+            index -= keep;
+         }
+      }
+
+      for( size_type k = n->myCount; k > index; k-- )
+         n->myVals[ k ] = n->myVals[ k - 1 ];
+      n->myVals[ index ] = val;
+      n->myCount++;
+      myData.mySize++;
+      return iterator( n, index );
+   }
+
+   // Removes from the list container the element at the specified position.
+   // Returns an iterator pointing to the element that followed the element erased.
+   // This is the container end if the operation erased the last element in the sequence.
+   // Takes time proportional to the capacity of a node, not to the size.
+   iterator erase( const_iterator where )
+   {
+      nodePtr n = where.myNode;
+      size_type index = where.myIndex;
+
+      n->myCount--;
+      for( size_type k = index; k < n->myCount; k++ )
+         n->myVals[ k ] = n->myVals[ k + 1 ];
+      myData.mySize--;
+
+      if( n->myCount == 0 )
+      {
+         nodePtr next = n->next;
+         unlinkNode( n );
+         return iterator( next, 0 );
+      }
+
+      if( n->myCount >= capacity / 2 || ( n->prev == myData.myHead && n->next == myData.myHead ) )
+         return following( n, index );
+
+      // n is less than half full: even it out with a neighbour, after it if
+      // it has one; "offset" is the position of the next element in the pair
+      nodePtr first = n;
+      size_type offset = index;
+      if( n->next == myData.myHead )
+      {
+         first = n->prev;
+         offset += first->myCount;
+      }
+
+      nodePtr second = first->next;
+      if( !rebalance( first, second ) )
+         return following( first, offset );
+      if( offset < first->myCount )
+         return iterator( first, offset );
+      return following( second, offset - first->myCount );
+   }
+
+   // Removes all elements from the list container (which are destroyed),
+   // and leaving the container with a size of 0.
+   void clear() // erase all
+   {
+      nodePtr x = myData.myHead->next;
+      while( x != myData.myHead )
+      {
+         nodePtr next = x->next;
+         delete x;
+         x = next;
+      }
+
+      myData.myHead->next = myData.myHead;
+      myData.myHead->prev = myData.myHead;
+      myData.mySize = 0;
+   }
+
+private:
+   ScaryVal myData;
+
+   // Allocates the head node, linked to itself
+   void makeHead()
+   {
+      myData.myHead = new node;
+      myData.myHead->myCount = 0;
+      myData.myHead->prev = myData.myHead->next = myData.myHead;
+   }
+
+   // Links a new, empty node in before "where" and returns it
+   nodePtr linkNodeBefore( nodePtr where )
+   {
+      nodePtr n = new node;
+      n->myCount = 0;
+      n->next = where;
+      n->prev = where->prev;
+      where->prev->next = n;
+      where->prev = n;
+      return n;
+   }
+
+   // Unlinks the node "where" and deletes it; its elements are not counted
+   void unlinkNode( nodePtr where )
+   {
+      where->prev->next = where->next;
+      where->next->prev = where->prev;
+      delete where;
+   }
+
+   // Returns an iterator to element "index" of n, or to the first element
+   // after n if index is n->myCount
+   iterator following( nodePtr n, size_type index )
+   {
+      if( index < n->myCount )
+         return iterator( n, index );
+      return iterator( n->next, 0 );
+   }
+
+   // Merges "second" into "first", which precedes it, if their elements fit
+   // in one node, and returns false; otherwise moves elements between them
+   // until they hold half each, and returns true.
+   bool rebalance( nodePtr first, nodePtr second )
+   {
+      size_type total = first->myCount + second->myCount;
+      if( total <= capacity )
+      {
+         for( size_type k = 0; k < second->myCount; k++ )
+            first->myVals[ first->myCount + k ] = second->myVals[ k ];
+         first->myCount = total;
+         unlinkNode( second );
+         return false;
+      }
+
+      size_type half = total / 2;
+      if( first->myCount < half ) // move the front of second to the back of first
+      {
+         size_type moved = half - first->myCount;
+         for( size_type k = 0; k < moved; k++ )
+            first->myVals[ first->myCount + k ] = second->myVals[ k ];
+         for( size_type k = moved; k < second->myCount; k++ )
+            second->myVals[ k - moved ] = second->myVals[ k ];
+         first->myCount = half;
+         second->myCount -= moved;
+      }
+      else // move the back of first to the front of second
+      {
+         size_type moved = first->myCount - half;
+         for( size_type k = second->myCount; k > 0; k-- )
+            second->myVals[ k - 1 + moved ] = second->myVals[ k - 1 ];
+         for( size_type k = 0; k < moved; k++ )
+            second->myVals[ k ] = first->myVals[ half + k ];
+         first->myCount = half;
+         second->myCount += moved;
+      }
+      return true;
+   }
+};
+
+// determine if two lists are equal and return true, otherwise return false
+template< typename Ty >
+bool operator==( const unrolled_list< Ty > &left, const unrolled_list< Ty > &right )
+{
+   if( left.size() != right.size() )
+      return false;
+
+   typename unrolled_list< Ty >::const_iterator it1 = left.begin();
+   typename unrolled_list< Ty >::const_iterator it2 = right.begin();
+   for( ; it1 != left.end(); ++it1, ++it2 )
+      if( *it1 != *it2 )
+         return false;
+
+   return true;
+}
+
+template< typename Ty >
+bool operator!=( const unrolled_list< Ty > &left, const unrolled_list< Ty > &right )
+{
+   return !( left == right );
+}
+
+#endif // UNROLLED_LIST
\ No newline at end of file
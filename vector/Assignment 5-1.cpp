@@ -3,25 +3,83 @@ using std::cout;
 using std::endl;
 using std::ostream;
 
-#include <fstream>
-using std::ifstream;
-using std::ios;
+#include <cstring>
 
 #include "Polynomial - 1111514 - hw5-1.h"
+#include "DatCorpus - 1111514 - hw5.h"
+#include "Pipeline - 1111514 - hw5.h"
 
 template< typename T >
 void testPolynomial();
 
+// computes square roots modulo a prime for the long long test cases
+void testModPolynomial();
+
+// squares every record of the corpus on all cores and reports timings
+template< typename T >
+void testBatch();
+
+// squares every record while the next ones are read and the previous printed
+template< typename T >
+void testPipeline();
+
+// prints the totals and timings of testBatch and testPipeline
+void printReport( const BatchReport &report );
+
+// takes the square roots of every record, and of polynomials that are not
+// perfect squares, in one batchSquareRoot call and compares them with
+// compSquareRoot's
 template< typename T >
-void load( ifstream &inFile, T coefficient[], T exponent[], int &numTerms );
+void testBatchSquareRoot();
 
-int main()
+int main( int argc, char *argv[] )
 {
+   // measure the multiplication thresholds now rather than in the first timed product
+   MultiplyDispatcher::prepare< Term< long long >, long long >();
+
+   // "batch" runs every record of each corpus through the thread pool instead
+   if( argc > 1 && strcmp( argv[ 1 ], "batch" ) == 0 )
+   {
+      testBatch< short >();
+
+      testBatch< long >();
+
+      testBatch< long long >();
+
+      return 0;
+   }
+
+   // "roots" takes all square roots of each corpus in one batch
+   if( argc > 1 && strcmp( argv[ 1 ], "roots" ) == 0 )
+   {
+      testBatchSquareRoot< short >();
+
+      testBatchSquareRoot< long >();
+
+      testBatchSquareRoot< long long >();
+
+      return 0;
+   }
+
+   // "pipeline" overlaps reading and printing with the computation instead
+   if( argc > 1 && strcmp( argv[ 1 ], "pipeline" ) == 0 )
+   {
+      testPipeline< short >();
+
+      testPipeline< long >();
+
+      testPipeline< long long >();
+
+      return 0;
+   }
+
    testPolynomial< short >();
 
    testPolynomial< long >();
 
    testPolynomial< long long >();
+
+   testModPolynomial();
 }
 
 const int arraySize = 20;
@@ -40,49 +98,181 @@ void testPolynomial()
        strcpy_s(fileName, 30, "Polynomials - long long.dat");
    }
 
-   ifstream inFile( fileName, ios::in | ios::binary );
+   const int numTestCases = 200;
+   DatCorpusReader< T, arraySize > corpus( fileName );
 
-   if( !inFile )
+   if( !corpus.isOpen() || corpus.size() < static_cast< size_t >( numTestCases ) )
    {
       cout << "File could not be opened" << endl;
       system( "pause" );
       exit( 1 );
    }
 
-   const int numTestCases = 200;
    int numErrors = numTestCases;
+   PolynomialWriter writer( cout ); // one write() per buffer, not per line
    for( int i = 0; i < numTestCases; i++ )
    {
-      T coefficient[ arraySize ] = {};
-      T exponent[ arraySize ] = {};
-      int numTerms = 0;
-
-      load( inFile, coefficient, exponent, numTerms );
+      DatRecord< T > record = corpus[ i ];
+      int numTerms = static_cast< int >( record.size() );
       Polynomial< Term< T >, T > polynomial( numTerms );
-      polynomial.setPolynomial( coefficient, exponent, numTerms );
-      cout << "polynomial: " << polynomial << endl;
+      polynomial.setPolynomial( record.coefficients(), record.exponents(), numTerms );
+      writer << "polynomial: " << polynomial << '\n';
 
       Polynomial< Term< T >, T > squareRoot = polynomial.compSquareRoot();
-      cout << "squareRoot: " << squareRoot << endl << endl;
+      writer << "squareRoot: " << squareRoot << "\n\n";
 
-      if( squareRoot * squareRoot == polynomial )
+      if( verifySquare( squareRoot, polynomial ) && verifySquare( squareRoot, polynomial, Verification::Exact ) )
          numErrors--;
    }
 
-   inFile.close();
+   writer.flush();
 
    cout << "There are " << numErrors << " errors!\n\n";
 
    system( "pause" );
 }
 
+void testModPolynomial()
+{
+   using Mod = ModInt<>;
+
+   const int numTestCases = 200; // the number of test cases
+   DatCorpusReader< long long, arraySize > corpus( "Polynomials - long long.dat" );
+
+   // exit program if the file could not be mapped
+   if( !corpus.isOpen() || corpus.size() < static_cast< size_t >( numTestCases ) )
+   {
+      cout << "File could not be opened" << endl;
+      system( "pause" );
+      exit( 1 );
+   }
+
+   int numErrors = numTestCases;
+   for( int i = 0; i < numTestCases; i++ )
+   {
+      DatRecord< long long > record = corpus[ i ];
+      int numTerms = static_cast< int >( record.size() );
+
+      // the coefficients are converted to Mod as they are stored
+      Polynomial< Term< Mod >, Mod > polynomial( numTerms );
+      polynomial.setPolynomial( record.coefficients(), record.exponents(), numTerms );
+
+      Polynomial< Term< Mod >, Mod > squareRoot = polynomial.compSquareRoot();
+
+      if( verifySquare( squareRoot, polynomial ) && verifySquare( squareRoot, polynomial, Verification::Exact ) )
+         numErrors--;
+   }
+
+   cout << "There are " << numErrors << " errors modulo " << Mod::modulus << "!\n\n";
+
+   system( "pause" );
+}
+
 template< typename T >
-void load( ifstream &inFile, T coefficient[], T exponent[], int &numTerms )
+void testBatch()
 {
-   inFile.read( reinterpret_cast< char * >( coefficient ), arraySize * sizeof( T ) );
-   inFile.read( reinterpret_cast< char * >( exponent ), arraySize * sizeof( T ) );
+   const char *fileName = sizeof( T ) == 2 ? "Polynomials - short.dat" :
+                          sizeof( T ) == 4 ? "Polynomials - long.dat" : "Polynomials - long long.dat";
+   DatCorpusReader< T, arraySize > corpus( fileName );
+
+   // exit program if the file could not be mapped
+   if( !corpus.isOpen() )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   PolynomialWriter writer( cout );
+   BatchReport report = squareRootBatch< Polynomial< Term< T >, T > >( corpus, writer );
+   printReport( report );
+}
+
+template< typename T >
+void testPipeline()
+{
+   const char *fileName = sizeof( T ) == 2 ? "Polynomials - short.dat" :
+                          sizeof( T ) == 4 ? "Polynomials - long.dat" : "Polynomials - long long.dat";
+
+   PolynomialWriter writer( cout );
+   BatchReport report = pipelinedSquareRoots< Polynomial< Term< T >, T >, T, arraySize >( fileName, writer );
+
+   // exit program if the file could not be read
+   if( report.numRecords == 0 )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   printReport( report );
+}
+
+void printReport( const BatchReport &report )
+{
+   cout << "There are " << report.numErrors << " errors!\n";
+   cout << report.numRecords << " records in " << report.seconds << " s on "
+        << ThreadPool::shared().size() << " threads: " << report.throughput() << " records/s\n";
+   cout << "latency (us): p50 " << report.p50 << ", p90 " << report.p90
+        << ", p99 " << report.p99 << ", max " << report.maximum << "\n\n";
+}
+
+template< typename T >
+void testBatchSquareRoot()
+{
+   using PolynomialType = Polynomial< Term< T >, T >;
+
+   const char *fileName = sizeof( T ) == 2 ? "Polynomials - short.dat" :
+                          sizeof( T ) == 4 ? "Polynomials - long.dat" : "Polynomials - long long.dat";
+   DatCorpusReader< T, arraySize > corpus( fileName );
+
+   // exit program if the file could not be mapped
+   if( !corpus.isOpen() )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   // after the records come polynomials that are not perfect squares: a
+   // negative leading coefficient, an odd leading exponent, a division
+   // that is not exact, and a root term below half the lowest exponent
+   const int numNonSquares = 4;
+   T nonSquareCoefficients[ numNonSquares ][ 3 ] = { { -1, 1 }, { 1, 1 }, { 1, 1, 1 }, { 1, 2, 3 } };
+   typename Term< T >::exponent_type nonSquareExponents[ numNonSquares ][ 3 ] =
+      { { 2, 0 }, { 3, 0 }, { 2, 1, 0 }, { 4, 3, 2 } };   // -x^2 + 1, x^3 + 1, x^2 + x + 1, x^4 + 2x^3 + 3x^2
+   const int nonSquareSizes[ numNonSquares ] = { 2, 2, 3, 3 };
+
+   size_t numRecords = corpus.size();
+   size_t numPolynomials = numRecords + numNonSquares;
+   PolynomialType *in = new PolynomialType[ numPolynomials ];
+   PolynomialType *out = new PolynomialType[ numPolynomials ];
+   bool *succeeded = new bool[ numPolynomials ];
+   for( size_t i = 0; i < numRecords; i++ )
+   {
+      DatRecord< T > record = corpus[ i ];
+      int numTerms = static_cast< int >( record.size() );
+      in[ i ] = PolynomialType( numTerms );
+      in[ i ].setPolynomial( record.coefficients(), record.exponents(), numTerms );
+   }
+   for( int k = 0; k < numNonSquares; k++ )
+   {
+      in[ numRecords + k ] = PolynomialType( nonSquareSizes[ k ] );
+      in[ numRecords + k ].setPolynomial( nonSquareCoefficients[ k ], nonSquareExponents[ k ], nonSquareSizes[ k ] );
+   }
+
+   size_t numSquares = PolynomialType::batchSquareRoot( std::span< const PolynomialType >( in, numPolynomials ),
+                                                        std::span< PolynomialType >( out, numPolynomials ),
+                                                        std::span< bool >( succeeded, numPolynomials ) );
+
+   int numErrors = numSquares == numRecords ? 0 : 1;
+   for( size_t i = 0; i < numRecords; i++ )
+      if( !succeeded[ i ] || !( out[ i ] == in[ i ].compSquareRoot() ) )
+         numErrors++;
+   for( size_t i = numRecords; i < numPolynomials; i++ )
+      if( succeeded[ i ] || out[ i ].size() != 0 )
+         numErrors++;
+
+   delete[] in;
+   delete[] out;
+   delete[] succeeded;
 
-   numTerms = arraySize;
-   while( numTerms > 0 && coefficient[ numTerms - 1 ] == 0 )
-      numTerms--;
+   cout << "There are " << numErrors << " errors in " << numPolynomials << " batched square roots!\n\n";
 }
\ No newline at end of file
@@ -3,25 +3,195 @@ using std::cout;
 using std::endl;
 using std::ostream;
 
+#include <cstdio>
+#include <cstring>
 #include <fstream>
-using std::ifstream;
-using std::ios;
+#include <sstream>
 
 #include "Polynomial - 1111514 - hw5-2.h"
+#include "BinaryCorpus - 1111514 - hw5.h"
+#include "DatCorpus - 1111514 - hw5.h"
+#include "FixedPolynomial - 1111514 - hw5.h"
+#include "PackedTerm - 1111514 - hw5.h"
+#include "Parse - 1111514 - hw5.h"
+#include "Pipeline - 1111514 - hw5.h"
+
+// FixedPolynomial is evaluated by the compiler: these fail to compile if
+// +, -, *, square, squareRoot or evaluate goes wrong
+using Fixed = FixedPolynomial< long long, 40 >;
+constexpr Fixed fixedRoot{ { 3, 16 }, { -2, 5 }, { 1, 0 } };       // 3x^16 - 2x^5 + 1
+constexpr Fixed fixedOther{ { 4, 1 }, { 1, 3 } };                  // x^3 + 4x
+static_assert( fixedRoot + fixedOther == Fixed{ { 3, 16 }, { -2, 5 }, { 1, 3 }, { 4, 1 }, { 1, 0 } } );
+static_assert( ( fixedRoot - fixedRoot ).zero() );
+static_assert( fixedRoot * fixedOther ==
+               Fixed{ { 3, 19 }, { 12, 17 }, { -2, 8 }, { -8, 6 }, { 1, 3 }, { 4, 1 } } );
+static_assert( fixedRoot.square() == Fixed{ { 9, 32 }, { -12, 21 }, { 6, 16 }, { 4, 10 }, { -4, 5 }, { 1, 0 } } );
+static_assert( fixedRoot.square().squareRoot() == fixedRoot );
+static_assert( ( fixedRoot * fixedOther ).square().squareRoot() == fixedRoot * fixedOther );
+static_assert( fixedRoot.square().evaluate( 2 ) == fixedRoot.evaluate( 2 ) * fixedRoot.evaluate( 2 ) );
 
 template< typename T >
 void testPolynomial();
 
+// computes square roots modulo a prime for the long long test cases
+void testModPolynomial();
+
+// squares every record of the corpus on all cores and reports timings
+template< typename T >
+void testBatch();
+
+// squares every record while the next ones are read and the previous printed
+template< typename T >
+void testPipeline();
+
+// prints the totals and timings of testBatch and testPipeline
+void printReport( const BatchReport &report );
+
+// takes the square roots of every record, and of polynomials that are not
+// perfect squares, in one batchSquareRoot call and compares them with
+// compSquareRoot's
+template< typename T >
+void testBatchSquareRoot();
+
+// multiplies large polynomials on one thread pool from two threads at once
+void testConcurrent();
+
+// computes the square roots with packed terms and compares them with vector's
+template< typename T, int CoefBits, int ExponBits >
+void testPacked( const char *name, long long scale );
+
+// parses what operator<< prints for every record and its square root, and
+// compares the result with the original
+template< typename T >
+void testParse();
+
+// checks where PolynomialParser reports malformed lines
+void testParseErrors();
+
+// compares the terms productTerms and squareTerms yield for every record with
+// those of operator* and square
+template< typename T >
+void testProductTerms();
+
+// checks that reading the first terms of a long product forms only the pairs
+// those terms need
+void testPrefixTerms();
+
+// writes every record and its square root to a binary corpus, maps it and
+// compares every term, then checks that damaged copies are not opened
 template< typename T >
-void load( ifstream &inFile, T coefficient[], T exponent[], int &numTerms );
+void testBinaryCorpus();
 
-int main()
+int main( int argc, char *argv[] )
 {
+   // measure the multiplication thresholds now rather than in the first timed product
+   MultiplyDispatcher::prepare< vector< Term< long long > >, long long >();
+
+   // "batch" runs every record of each corpus through the thread pool instead
+   if( argc > 1 && strcmp( argv[ 1 ], "batch" ) == 0 )
+   {
+      testBatch< short >();
+
+      testBatch< long >();
+
+      testBatch< long long >();
+
+      return 0;
+   }
+
+   // "roots" takes all square roots of each corpus in one batch
+   if( argc > 1 && strcmp( argv[ 1 ], "roots" ) == 0 )
+   {
+      testBatchSquareRoot< short >();
+
+      testBatchSquareRoot< long >();
+
+      testBatchSquareRoot< long long >();
+
+      return 0;
+   }
+
+   // "pipeline" overlaps reading and printing with the computation instead
+   if( argc > 1 && strcmp( argv[ 1 ], "pipeline" ) == 0 )
+   {
+      testPipeline< short >();
+
+      testPipeline< long >();
+
+      testPipeline< long long >();
+
+      return 0;
+   }
+
+   // "packed" runs the records with the terms in a PackedTermVector
+   if( argc > 1 && strcmp( argv[ 1 ], "packed" ) == 0 )
+   {
+      testPacked< short, 16, 16 >( "short, 16 + 16 bits", 1 );
+
+      // exponents from 2^19 to 2^20 still pack into 20 bits
+      testPacked< long long, 44, 20 >( "long long, 44 + 20 bits, exponents * 2^15", 1 << 15 );
+
+      // most records do not fit, so the containers widen part way
+      testPacked< long long, 8, 4 >( "long long, 8 + 4 bits", 1 );
+
+      return 0;
+   }
+
+   // "parse" reads the printed records back with PolynomialParser
+   if( argc > 1 && strcmp( argv[ 1 ], "parse" ) == 0 )
+   {
+      testParse< short >();
+
+      testParse< long >();
+
+      testParse< long long >();
+
+      testParseErrors();
+
+      return 0;
+   }
+
+   // "generator" reads products and squares term by term
+   if( argc > 1 && strcmp( argv[ 1 ], "generator" ) == 0 )
+   {
+      testProductTerms< short >();
+
+      testProductTerms< long >();
+
+      testProductTerms< long long >();
+
+      testPrefixTerms();
+
+      return 0;
+   }
+
+   // "binary" writes the corpora in the binary format and reads them back
+   if( argc > 1 && strcmp( argv[ 1 ], "binary" ) == 0 )
+   {
+      testBinaryCorpus< short >();
+
+      testBinaryCorpus< long >();
+
+      testBinaryCorpus< long long >();
+
+      return 0;
+   }
+
+   // "concurrent" checks products that share the pool between two threads
+   if( argc > 1 && strcmp( argv[ 1 ], "concurrent" ) == 0 )
+   {
+      testConcurrent();
+
+      return 0;
+   }
+
    testPolynomial< short >();
 
    testPolynomial< long >();
 
    testPolynomial< long long >();
+
+   testModPolynomial();
 }
 
 const int arraySize = 20;
@@ -37,50 +207,629 @@ void testPolynomial()
    else if( sizeof( T ) == 8 )
       strcpy_s( fileName, 30, "Polynomials - long long.dat" );
 
-   ifstream inFile( fileName, ios::in | ios::binary );
+   const int numTestCases = 200; // the number of test cases
+   DatCorpusReader< T, arraySize > corpus( fileName );
 
-   // exit program if ifstream could not open file
-   if( !inFile )
+   // exit program if the file could not be mapped
+   if( !corpus.isOpen() || corpus.size() < static_cast< size_t >( numTestCases ) )
    {
       cout << "File could not be opened" << endl;
       system( "pause" );
       exit( 1 );
    }
 
-   const int numTestCases = 200; // the number of test cases
    int numErrors = numTestCases;
+   PolynomialWriter writer( cout ); // one write() per buffer, not per line
    for( int i = 0; i < numTestCases; i++ )
    {
-      T coefficient[ arraySize ] = {};
-      T exponent[ arraySize ] = {};
-      int numTerms = 0;
-
-      load( inFile, coefficient, exponent, numTerms );
+      DatRecord< T > record = corpus[ i ];
+      int numTerms = static_cast< int >( record.size() );
       Polynomial< vector< Term< T > >, T > polynomial( numTerms );
-      polynomial.setPolynomial( coefficient, exponent, numTerms );
-      cout << "polynomial: " << polynomial << endl;
+      polynomial.setPolynomial( record.coefficients(), record.exponents(), numTerms );
+      writer << "polynomial: " << polynomial << '\n';
 
       Polynomial< vector< Term< T > >, T > squareRoot = polynomial.compSquareRoot();
-      cout << "squareRoot: " << squareRoot << endl << endl;
+      writer << "squareRoot: " << squareRoot << "\n\n";
 
-      if( squareRoot * squareRoot == polynomial )
+      if( verifySquare( squareRoot, polynomial ) && verifySquare( squareRoot, polynomial, Verification::Exact ) )
          numErrors--;
    }
 
-   inFile.close();
+   writer.flush();
 
    cout << "There are " << numErrors << " errors!\n\n";
 
    system( "pause" );
 }
 
+void testModPolynomial()
+{
+   using Mod = ModInt<>;
+
+   const int numTestCases = 200; // the number of test cases
+   DatCorpusReader< long long, arraySize > corpus( "Polynomials - long long.dat" );
+
+   // exit program if the file could not be mapped
+   if( !corpus.isOpen() || corpus.size() < static_cast< size_t >( numTestCases ) )
+   {
+      cout << "File could not be opened" << endl;
+      system( "pause" );
+      exit( 1 );
+   }
+
+   int numErrors = numTestCases;
+   for( int i = 0; i < numTestCases; i++ )
+   {
+      DatRecord< long long > record = corpus[ i ];
+      int numTerms = static_cast< int >( record.size() );
+
+      // the coefficients are converted to Mod as they are stored
+      Polynomial< vector< Term< Mod > >, Mod > polynomial( numTerms );
+      polynomial.setPolynomial( record.coefficients(), record.exponents(), numTerms );
+
+      Polynomial< vector< Term< Mod > >, Mod > squareRoot = polynomial.compSquareRoot();
+
+      if( verifySquare( squareRoot, polynomial ) && verifySquare( squareRoot, polynomial, Verification::Exact ) )
+         numErrors--;
+   }
+
+   cout << "There are " << numErrors << " errors modulo " << Mod::modulus << "!\n\n";
+
+   system( "pause" );
+}
+
+template< typename T >
+void testBatch()
+{
+   const char *fileName = sizeof( T ) == 2 ? "Polynomials - short.dat" :
+                          sizeof( T ) == 4 ? "Polynomials - long.dat" : "Polynomials - long long.dat";
+   DatCorpusReader< T, arraySize > corpus( fileName );
+
+   // exit program if the file could not be mapped
+   if( !corpus.isOpen() )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   PolynomialWriter writer( cout );
+   BatchReport report = squareRootBatch< Polynomial< vector< Term< T > >, T > >( corpus, writer );
+   printReport( report );
+}
+
+template< typename T >
+void testPipeline()
+{
+   const char *fileName = sizeof( T ) == 2 ? "Polynomials - short.dat" :
+                          sizeof( T ) == 4 ? "Polynomials - long.dat" : "Polynomials - long long.dat";
+
+   PolynomialWriter writer( cout );
+   BatchReport report = pipelinedSquareRoots< Polynomial< vector< Term< T > >, T >, T, arraySize >( fileName, writer );
+
+   // exit program if the file could not be read
+   if( report.numRecords == 0 )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   printReport( report );
+}
+
+void printReport( const BatchReport &report )
+{
+   cout << "There are " << report.numErrors << " errors!\n";
+   cout << report.numRecords << " records in " << report.seconds << " s on "
+        << ThreadPool::shared().size() << " threads: " << report.throughput() << " records/s\n";
+   cout << "latency (us): p50 " << report.p50 << ", p90 " << report.p90
+        << ", p99 " << report.p99 << ", max " << report.maximum << "\n\n";
+}
+
+template< typename T >
+void testBatchSquareRoot()
+{
+   using PolynomialType = Polynomial< vector< Term< T > >, T >;
+
+   const char *fileName = sizeof( T ) == 2 ? "Polynomials - short.dat" :
+                          sizeof( T ) == 4 ? "Polynomials - long.dat" : "Polynomials - long long.dat";
+   DatCorpusReader< T, arraySize > corpus( fileName );
+
+   // exit program if the file could not be mapped
+   if( !corpus.isOpen() )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   // after the records come polynomials that are not perfect squares: a
+   // negative leading coefficient, an odd leading exponent, a division
+   // that is not exact, and a root term below half the lowest exponent
+   const int numNonSquares = 4;
+   T nonSquareCoefficients[ numNonSquares ][ 3 ] = { { -1, 1 }, { 1, 1 }, { 1, 1, 1 }, { 1, 2, 3 } };
+   typename Term< T >::exponent_type nonSquareExponents[ numNonSquares ][ 3 ] =
+      { { 2, 0 }, { 3, 0 }, { 2, 1, 0 }, { 4, 3, 2 } };   // -x^2 + 1, x^3 + 1, x^2 + x + 1, x^4 + 2x^3 + 3x^2
+   const int nonSquareSizes[ numNonSquares ] = { 2, 2, 3, 3 };
+
+   size_t numRecords = corpus.size();
+   size_t numPolynomials = numRecords + numNonSquares;
+   PolynomialType *in = new PolynomialType[ numPolynomials ];
+   PolynomialType *out = new PolynomialType[ numPolynomials ];
+   bool *succeeded = new bool[ numPolynomials ];
+   for( size_t i = 0; i < numRecords; i++ )
+   {
+      DatRecord< T > record = corpus[ i ];
+      int numTerms = static_cast< int >( record.size() );
+      in[ i ] = PolynomialType( numTerms );
+      in[ i ].setPolynomial( record.coefficients(), record.exponents(), numTerms );
+   }
+   for( int k = 0; k < numNonSquares; k++ )
+   {
+      in[ numRecords + k ] = PolynomialType( nonSquareSizes[ k ] );
+      in[ numRecords + k ].setPolynomial( nonSquareCoefficients[ k ], nonSquareExponents[ k ], nonSquareSizes[ k ] );
+   }
+
+   size_t numSquares = PolynomialType::batchSquareRoot( std::span< const PolynomialType >( in, numPolynomials ),
+                                                        std::span< PolynomialType >( out, numPolynomials ),
+                                                        std::span< bool >( succeeded, numPolynomials ) );
+
+   int numErrors = numSquares == numRecords ? 0 : 1;
+   for( size_t i = 0; i < numRecords; i++ )
+      if( !succeeded[ i ] || !( out[ i ] == in[ i ].compSquareRoot() ) )
+         numErrors++;
+   for( size_t i = numRecords; i < numPolynomials; i++ )
+      if( succeeded[ i ] || out[ i ].size() != 0 )
+         numErrors++;
+
+   delete[] in;
+   delete[] out;
+   delete[] succeeded;
+
+   cout << "There are " << numErrors << " errors in " << numPolynomials << " batched square roots!\n\n";
+}
+
+template< typename T, int CoefBits, int ExponBits >
+void testPacked( const char *name, long long scale )
+{
+   using Codec = PackedTermCodec< T, CoefBits, ExponBits >;
+   using PackedPolynomial = Polynomial< PackedTermVector< T, CoefBits, ExponBits >, T >;
+   using PlainPolynomial = Polynomial< vector< Term< T > >, T >;
+
+   const char *fileName = sizeof( T ) == 2 ? "Polynomials - short.dat" :
+                          sizeof( T ) == 4 ? "Polynomials - long.dat" : "Polynomials - long long.dat";
+   DatCorpusReader< T, arraySize > corpus( fileName );
+
+   // exit program if the file could not be mapped
+   if( !corpus.isOpen() )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   int numErrors = 0;
+   int numPacked = 0; // records whose terms all fit in a word
+   T coefficients[ arraySize ];
+   long long exponents[ arraySize ];
+   for( size_t i = 0; i < corpus.size(); i++ )
+   {
+      DatRecord< T > record = corpus[ i ];
+      int numTerms = static_cast< int >( record.size() );
+      bool fits = true;
+      for( int j = 0; j < numTerms; j++ )
+      {
+         coefficients[ j ] = record.coefficients()[ j ];
+         exponents[ j ] = record.exponents()[ j ] * scale;
+         fits = fits && Codec::fits( coefficients[ j ], static_cast< T >( exponents[ j ] ) );
+      }
+      if( fits )
+         numPacked++;
+
+      PackedPolynomial packed( numTerms );
+      packed.setPolynomial( coefficients, exponents, numTerms );
+      PlainPolynomial plain( numTerms );
+      plain.setPolynomial( coefficients, exponents, numTerms );
+
+      // the proxies are written by compSquareRoot, operator* and +=
+      PackedPolynomial packedRoot = packed.compSquareRoot();
+      PlainPolynomial plainRoot = plain.compSquareRoot();
+      PackedPolynomial packedSquare = packedRoot * packedRoot;
+      packedSquare -= packed;
+
+      bool same = packedRoot.size() == plainRoot.size() && packedSquare.size() == 0;
+      for( size_t k = 0; same && k < plainRoot.size(); k++ )
+         same = packedRoot.term( k ) == plainRoot.term( k );
+
+      if( !same || !verifySquare( packedRoot, packed ) )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors with " << name << " ("
+        << numPacked << " of " << corpus.size() << " records packed)!\n\n";
+}
+
+template< typename T >
+void testParse()
+{
+   using PolynomialType = Polynomial< vector< Term< T > >, T >;
+
+   const char *fileName = sizeof( T ) == 2 ? "Polynomials - short.dat" :
+                          sizeof( T ) == 4 ? "Polynomials - long.dat" : "Polynomials - long long.dat";
+   DatCorpusReader< T, arraySize > corpus( fileName );
+
+   // exit program if the file could not be mapped
+   if( !corpus.isOpen() )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   // each record and its square root on a line of their own
+   size_t numPolynomials = 2 * corpus.size();
+   PolynomialType *polynomials = new PolynomialType[ numPolynomials ];
+   std::ostringstream text;
+   for( size_t i = 0; i < corpus.size(); i++ )
+   {
+      DatRecord< T > record = corpus[ i ];
+      int numTerms = static_cast< int >( record.size() );
+      polynomials[ 2 * i ] = PolynomialType( numTerms );
+      polynomials[ 2 * i ].setPolynomial( record.coefficients(), record.exponents(), numTerms );
+      polynomials[ 2 * i + 1 ] = polynomials[ 2 * i ].compSquareRoot();
+      text << polynomials[ 2 * i ] << '\n' << polynomials[ 2 * i + 1 ] << '\n';
+   }
+
+   std::string lines = text.str();
+   PolynomialParser< T > parser( lines.data(), lines.data() + lines.size() );
+   PolynomialType parsed;
+   size_t numParsed = 0;
+   int numErrors = 0;
+   for( ; parser.next( parsed ); numParsed++ )
+      if( numParsed >= numPolynomials || !( parsed == polynomials[ numParsed ] ) )
+         numErrors++;
+
+   if( parser.error().message != nullptr || numParsed != numPolynomials )
+      numErrors++;
+
+   delete[] polynomials;
+
+   cout << "There are " << numErrors << " errors in " << numPolynomials << " parsed polynomials!\n\n";
+}
+
+void testParseErrors()
+{
+   // a malformed line, and where the parser should report it
+   struct Case
+   {
+      const char *text;
+      const char *message;
+      size_t line;
+      size_t column;
+      size_t offset;
+   };
+
+   const Case cases[] =
+   {
+      { "x^2 + 1\n",                  "expected a coefficient", 1, 1, 0 },
+      { "3x^4 - 2x + 1\n\n2x^2 + 3x +\n", "expected \" + \", \" - \" or the end of the line", 3, 10, 24 },
+      { "1\r\n5x^2 + 3x^3\r\n",          "exponents must decrease", 2, 12, 14 },
+      { "2x^-1",                       "expected an exponent", 1, 4, 3 },
+      { "7\n0x",                        "zero coefficient", 2, 1, 2 },
+      { "-40000x^2",                   "coefficient out of range", 1, 2, 1 },
+      { "5x^99999",                    "exponent out of range", 1, 4, 3 },
+      { "5x^2 + x",                    "expected a coefficient", 1, 8, 7 }
+   };
+
+   int numErrors = 0;
+   for( const Case &test : cases )
+   {
+      PolynomialParser< short > parser( test.text, test.text + strlen( test.text ) );
+      Polynomial< vector< Term< short > >, short > polynomial;
+      while( parser.next( polynomial ) )
+         ;
+
+      const ParseError &error = parser.error();
+      if( error.message == nullptr || strcmp( error.message, test.message ) != 0 ||
+          error.line != test.line || error.column != test.column || error.offset != test.offset )
+         numErrors++;
+   }
+
+   cout << "There are " << numErrors << " errors in " << sizeof( cases ) / sizeof( cases[ 0 ] )
+        << " malformed polynomials!\n\n";
+}
+
+template< typename T >
+void testProductTerms()
+{
+   using PolynomialType = Polynomial< vector< Term< T > >, T >;
+
+   const char *fileName = sizeof( T ) == 2 ? "Polynomials - short.dat" :
+                          sizeof( T ) == 4 ? "Polynomials - long.dat" : "Polynomials - long long.dat";
+   DatCorpusReader< T, arraySize > corpus( fileName );
+
+   // exit program if the file could not be mapped
+   if( !corpus.isOpen() || corpus.size() == 0 )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   // returns true if "terms" yields exactly the terms of "expected"
+   auto sameTerms = []( TermGenerator< T > terms, const PolynomialType &expected )
+   {
+      size_t k = 0;
+      for( const Term< T > &term : terms )
+         if( k >= expected.size() || term != expected.term( k++ ) )
+            return false;
+      return k == expected.size();
+   };
+
+   // each record times the next, and each record squared
+   int numErrors = 0;
+   PolynomialType previous;
+   for( size_t i = 0; i <= corpus.size(); i++ )
+   {
+      PolynomialType polynomial;
+      if( i < corpus.size() )
+      {
+         DatRecord< T > record = corpus[ i ];
+         int numTerms = static_cast< int >( record.size() );
+         polynomial = PolynomialType( numTerms );
+         polynomial.setPolynomial( record.coefficients(), record.exponents(), numTerms );
+      }
+
+      // the last product has the zero polynomial as its right operand
+      if( i > 0 && !sameTerms( previous.productTerms( polynomial ), previous * polynomial ) )
+         numErrors++;
+
+      if( !sameTerms( polynomial.squareTerms(), polynomial.square() ) )
+         numErrors++;
+
+      previous = polynomial;
+   }
+
+   cout << "There are " << numErrors << " errors in " << 2 * corpus.size() + 1
+        << " products read term by term!\n\n";
+}
+
+// A coefficient that counts the products formed with it
+struct CountedCoefficient
+{
+   static long long numProducts;
+
+   CountedCoefficient( long long v = 0 )
+      : value( v )
+   {
+   }
+
+   CountedCoefficient operator*( const CountedCoefficient &right ) const
+   {
+      numProducts++;
+      return CountedCoefficient( value * right.value );
+   }
+
+   CountedCoefficient& operator+=( const CountedCoefficient &right )
+   {
+      value += right.value;
+      return *this;
+   }
+
+   bool operator!=( const CountedCoefficient &right ) const
+   {
+      return value != right.value;
+   }
+
+   long long value;
+};
+
+long long CountedCoefficient::numProducts = 0;
+
+template<>
+struct TermExponent< CountedCoefficient >
+{
+   using type = long long;
+};
+
+void testPrefixTerms()
+{
+   // ( x^( n - 1 ) + ... + x + 1 )^2 has the coefficients 1, 2, ..., n, ..., 2, 1,
+   // and its t-th term comes from t + 1 of the n * n pairs
+   const size_t n = 1000;
+   const size_t numRead = 10;
+   Term< CountedCoefficient > *terms = new Term< CountedCoefficient >[ n ];
+   for( size_t i = 0; i < n; i++ )
+   {
+      terms[ i ].coef = 1;
+      terms[ i ].expon = static_cast< long long >( n - 1 - i );
+   }
+
+   int numErrors = 0;
+   CountedCoefficient::numProducts = 0;
+   {
+      // the generator is destroyed with the rest of the product unformed
+      TermGenerator< CountedCoefficient > product = productTerms( terms, n, terms, n, false );
+      Term< CountedCoefficient > term;
+      for( size_t t = 0; t < numRead; t++ )
+         if( !product.next( term ) || term.coef.value != static_cast< long long >( t + 1 ) ||
+             term.expon != static_cast< long long >( 2 * ( n - 1 ) - t ) )
+            numErrors++;
+   }
+
+   if( CountedCoefficient::numProducts != static_cast< long long >( numRead * ( numRead + 1 ) / 2 ) )
+      numErrors++;
+
+   delete[] terms;
+
+   cout << "There are " << numErrors << " errors in the first " << numRead << " terms of a product of "
+        << n * n << " pairs!\n\n";
+}
+
 template< typename T >
-void load( ifstream &inFile, T coefficient[], T exponent[], int &numTerms )
+void testBinaryCorpus()
+{
+   using PolynomialType = Polynomial< vector< Term< T > >, T >;
+
+   const char *fileName = sizeof( T ) == 2 ? "Polynomials - short.dat" :
+                          sizeof( T ) == 4 ? "Polynomials - long.dat" : "Polynomials - long long.dat";
+   DatCorpusReader< T, arraySize > corpus( fileName );
+
+   // exit program if the file could not be mapped
+   if( !corpus.isOpen() )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   // record i of the binary corpus is record i of the .dat corpus, and
+   // record corpus.size() + i its square root, written as a Polynomial
+   size_t numRecords = corpus.size();
+   PolynomialType *roots = new PolynomialType[ numRecords ];
+   const char *binaryName = "Polynomials - test.plyb";
+   int numErrors = 0;
+   {
+      std::ofstream outFile( binaryName, std::ios::binary );
+      BinaryCorpusWriter< T > writer( outFile );
+      for( size_t i = 0; i < numRecords; i++ )
+         if( !writer.write( corpus[ i ].coefficients(), corpus[ i ].exponents(), corpus[ i ].size() ) )
+            numErrors++;
+      for( size_t i = 0; i < numRecords; i++ )
+      {
+         DatRecord< T > record = corpus[ i ];
+         PolynomialType polynomial( static_cast< int >( record.size() ) );
+         polynomial.setPolynomial( record.coefficients(), record.exponents(), static_cast< int >( record.size() ) );
+         roots[ i ] = polynomial.compSquareRoot();
+         if( !writer.write( roots[ i ] ) )
+            numErrors++;
+      }
+   }
+
+   // the reader unmaps the file before the damaged copies overwrite it
+   {
+      BinaryCorpusReader< T > reader( binaryName );
+      if( !reader.isOpen() || reader.size() != 2 * numRecords )
+         numErrors++;
+      else
+         for( size_t i = 0; i < reader.size(); i++ )
+         {
+            BinaryRecord< T, T > record = reader[ i ];
+            size_t numTerms = i < numRecords ? corpus[ i ].size() : roots[ i - numRecords ].size();
+            if( record.size() != numTerms )
+            {
+               numErrors++;
+               continue;
+            }
+
+            VarintExponentIterator< T > exponent = record.exponents();
+            for( size_t k = 0; k < numTerms; k++, ++exponent )
+            {
+               Term< T > expected;
+               if( i < numRecords )
+               {
+                  expected.coef = corpus[ i ].coefficients()[ k ];
+                  expected.expon = corpus[ i ].exponents()[ k ];
+               }
+               else
+                  expected = roots[ i - numRecords ].term( k );
+
+               if( record.coefficients()[ k ] != expected.coef || *exponent != expected.expon )
+               {
+                  numErrors++;
+                  break;
+               }
+            }
+            if( exponent != record.exponentsEnd() )
+               numErrors++;
+         }
+   }
+
+   cout << "There are " << numErrors << " errors in " << 2 * numRecords << " binary records!\n";
+
+   // damaged copies: cut short, a wrong magic number, a wrong version, and
+   // read as coefficients of another size; none may be opened
+   std::string bytes;
+   {
+      std::ifstream inFile( binaryName, std::ios::binary );
+      std::ostringstream contents;
+      contents << inFile.rdbuf();
+      bytes = contents.str();
+   }
+
+   const int numDamaged = 5;
+   int numDamagedErrors = 0;
+   for( int k = 0; k < numDamaged; k++ )
+   {
+      std::string damaged = bytes;
+      if( k == 0 )
+         damaged.resize( damaged.size() - 8 );   // the index loses its last offset
+      else if( k == 1 )
+         damaged.resize( sizeof( BinaryCorpusHeader ) - 1 );
+      else if( k == 2 )
+         damaged[ 0 ] = 'X';
+      else if( k == 3 )
+         damaged[ 4 ]++;
+
+      {
+         std::ofstream outFile( binaryName, std::ios::binary );
+         outFile.write( damaged.data(), static_cast< std::streamsize >( damaged.size() ) );
+      }
+
+      bool opened;
+      if( k == 4 )
+         opened = BinaryCorpusReader< char >( binaryName ).isOpen();
+      else
+         opened = BinaryCorpusReader< T >( binaryName ).isOpen();
+      if( opened )
+         numDamagedErrors++;
+   }
+
+   remove( binaryName );
+   delete[] roots;
+
+   cout << "There are " << numDamagedErrors << " errors in " << numDamaged << " damaged corpora!\n\n";
+}
+
+void testConcurrent()
 {
-   inFile.read( reinterpret_cast< char * >( coefficient ), arraySize * sizeof( T ) );
-   inFile.read( reinterpret_cast< char * >( exponent ), arraySize * sizeof( T ) );
+   using PolynomialType = Polynomial< vector< Term< long long > >, long long >;
+
+   // two sparse operands, large enough for the parallel strategy
+   const int numTerms = 600;
+   long long coefficients[ numTerms ];
+   long long exponents[ numTerms ];
+   PolynomialType operands[ 2 ];
+   for( int k = 0; k < 2; k++ )
+   {
+      for( int i = 0; i < numTerms; i++ )
+      {
+         coefficients[ i ] = ( i * ( k + 3 ) ) % 7 + 1;
+         exponents[ i ] = static_cast< long long >( numTerms - i ) * ( 5 + k ) + i % 3;
+      }
+      operands[ k ] = PolynomialType( numTerms );
+      operands[ k ].setPolynomial( coefficients, exponents, numTerms );
+   }
+
+   PolynomialType expected[ 2 ] = { operands[ 0 ].multiplyHashed( operands[ 1 ] ),
+                                    operands[ 1 ].multiplyHashed( operands[ 1 ] ) };
+
+   // each thread multiplies its own pair on the pool, which has workers even
+   // on a single core, and through operator*, which may use the shared pool
+   ThreadPool pool( 3 );
+   const int numRounds = 20;
+   std::atomic< int > numErrors( 0 );
+   std::thread threads[ 2 ];
+   for( int k = 0; k < 2; k++ )
+      threads[ k ] = std::thread( [ &, k ]
+      {
+         PolynomialType left = operands[ k ];
+         PolynomialType right = operands[ 1 ];
+         for( int round = 0; round < numRounds; round++ )
+         {
+            if( !( left.multiplyParallel( right, pool ) == expected[ k ] ) )
+               numErrors++;
+            if( !( left * right == expected[ k ] ) )
+               numErrors++;
+         }
+      } );
+
+   for( int k = 0; k < 2; k++ )
+      threads[ k ].join();
 
-   numTerms = arraySize;
-   while( numTerms > 0 && coefficient[ numTerms - 1 ] == 0 )
-      numTerms--;
+   cout << "There are " << numErrors << " errors in " << 4 * numRounds << " concurrent products!\n\n";
 }
\ No newline at end of file
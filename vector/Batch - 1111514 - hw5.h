@@ -0,0 +1,118 @@
+// Batch header
+// Computes and verifies the square roots of every record of a corpus on all
+// threads of a pool, and writes the results in input order.
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+#include "Format - 1111514 - hw5.h"
+#include "ThreadPool - 1111514 - hw5.h"
+
+// Totals and timings of one batch; latencies are in microseconds.
+struct BatchReport
+{
+   size_t numRecords;  // the number of records processed
+   size_t numErrors;   // records whose square root failed verification
+   double seconds;     // wall-clock time of the whole batch
+   double p50;         // median latency of one record
+   double p90;         // 90th percentile latency
+   double p99;         // 99th percentile latency
+   double maximum;     // the slowest record
+
+   // Returns the number of records processed per second.
+   double throughput() const
+   {
+      return seconds > 0 ? numRecords / seconds : 0;
+   }
+};
+
+// Builds "polynomial" from "record", computes its square root into "root" and
+// returns whether the root passes verification. Returns the time taken, in
+// microseconds, in "latency".
+template< typename PolynomialType, typename Record >
+bool squareRootRecord( const Record &record, PolynomialType &polynomial, PolynomialType &root,
+                       double &latency )
+{
+   std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+   int numTerms = static_cast< int >( record.size() );
+   PolynomialType built( numTerms );
+   built.setPolynomial( record.coefficients(), record.exponents(), numTerms );
+
+   root = built.compSquareRoot();
+   bool verified = verifySquare( root, built );
+   polynomial = built;
+
+   latency = std::chrono::duration< double, std::micro >( std::chrono::steady_clock::now() - begin ).count();
+   return verified;
+}
+
+// Sorts latencies[ 0 .. count ) and stores their percentiles in "report".
+inline void setLatencyPercentiles( BatchReport &report, double *latencies, size_t count )
+{
+   if( count == 0 )
+      return;
+
+   std::sort( latencies, latencies + count );
+   report.p50 = latencies[ ( count - 1 ) * 50 / 100 ];
+   report.p90 = latencies[ ( count - 1 ) * 90 / 100 ];
+   report.p99 = latencies[ ( count - 1 ) * 99 / 100 ];
+   report.maximum = latencies[ count - 1 ];
+}
+
+// Squares the roots of all records of "corpus" on "pool", blockSize records at
+// a time, and writes "polynomial: " and "squareRoot: " lines for every record,
+// in input order, exactly as the sequential drivers do. PolynomialType is the
+// polynomial built from a record; corpus[ i ] must return a record with
+// size(), coefficients() and exponents(). Only one block of results is held.
+template< typename PolynomialType, typename Corpus >
+BatchReport squareRootBatch( const Corpus &corpus, PolynomialWriter &writer,
+                             ThreadPool &pool = ThreadPool::shared(), size_t blockSize = 4096 )
+{
+   using clock = std::chrono::steady_clock;
+
+   size_t numRecords = corpus.size();
+   PolynomialType *polynomials = new PolynomialType[ blockSize ];
+   PolynomialType *roots = new PolynomialType[ blockSize ];
+   bool *verified = new bool[ blockSize ];
+   double *latencies = new double[ numRecords > 0 ? numRecords : 1 ];
+
+   BatchReport report = {};
+   report.numRecords = numRecords;
+   clock::time_point start = clock::now();
+
+   for( size_t first = 0; first < numRecords; first += blockSize )
+   {
+      size_t count = std::min( blockSize, numRecords - first );
+      pool.run( count, [ & ]( size_t j )
+      {
+         verified[ j ] = squareRootRecord( corpus[ first + j ], polynomials[ j ], roots[ j ],
+                                           latencies[ first + j ] );
+      } );
+
+      for( size_t j = 0; j < count; j++ )
+      {
+         writer << "polynomial: " << polynomials[ j ] << '\n';
+         writer << "squareRoot: " << roots[ j ] << "\n\n";
+         if( !verified[ j ] )
+            report.numErrors++;
+      }
+   }
+
+   writer.flush();
+   report.seconds = std::chrono::duration< double >( clock::now() - start ).count();
+
+   setLatencyPercentiles( report, latencies, numRecords );
+
+   delete[] latencies;
+   delete[] verified;
+   delete[] roots;
+   delete[] polynomials;
+   return report;
+}
+
+#endif // BATCH_H
\ No newline at end of file
@@ -0,0 +1,447 @@
+// Benchmark of the polynomial operations
+// Times operator+=, operator*, square, compSquareRoot and verifySquare for
+// short, long and long long coefficients, over the shipped .dat corpora and
+// over random polynomials of 10 to 10^6 terms, and reports ns per operation,
+// ns per input term and heap allocations per operation, as a table and as JSON.
+// The same operations are then timed with the terms held in vector, std::list,
+// std::deque and PackedTermVector.
+//
+// usage: Benchmark [--max-work N] [--seed N] [--json fileName]
+//                  [--dat fileName] [--record-terms N]
+// Inputs whose estimated work (term operations) exceeds --max-work are skipped.
+// --dat also times a long long corpus written by Generator --bytes 8, whose
+// records hold --record-terms terms (20).
+
+#include <iostream>
+using std::cout;
+using std::endl;
+using std::ostream;
+
+#include <fstream>
+using std::ofstream;
+
+#include <atomic>
+#include <deque>
+#include <list>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <random>
+
+#include "Polynomial - 1111514 - hw5-2.h"
+#include "DatCorpus - 1111514 - hw5.h"
+#include "PackedTerm - 1111514 - hw5.h"
+
+// the number of operator new calls so far, on all threads
+std::atomic< size_t > numAllocations( 0 );
+
+// Counts an allocation and returns "size" bytes from malloc. Every form of
+// operator new allocates here and every form of operator delete frees, so
+// the array forms do not go through the plain ones.
+void* countedAllocate( size_t size )
+{
+   numAllocations.fetch_add( 1, std::memory_order_relaxed );
+   if( void *p = malloc( size > 0 ? size : 1 ) )
+      return p;
+   throw std::bad_alloc();
+}
+
+void* operator new( size_t size )
+{
+   return countedAllocate( size );
+}
+
+void* operator new[]( size_t size )
+{
+   return countedAllocate( size );
+}
+
+void operator delete( void *p ) noexcept
+{
+   free( p );
+}
+
+void operator delete[]( void *p ) noexcept
+{
+   free( p );
+}
+
+void operator delete( void *p, size_t ) noexcept
+{
+   free( p );
+}
+
+void operator delete[]( void *p, size_t ) noexcept
+{
+   free( p );
+}
+
+// One line of the report
+struct Result
+{
+   const char *operation;  // "+=", "*", "square", "compSquareRoot" or "verifySquare"
+   const char *type;       // the coefficient type
+   const char *container;  // the container of the terms: "vector", "list", "deque" or "packed"
+   const char *input;      // "dat" or "random"
+   size_t numTerms;        // input terms per operation
+   size_t repetitions;     // the number of operations timed
+   double nsPerOperation;  // mean time of one operation
+   double nsPerTerm;       // nsPerOperation / numTerms
+   double allocations;     // mean operator new calls per operation
+};
+
+template< typename T >
+using Poly = Polynomial< vector< Term< T > >, T >;
+
+vector< Result > results;       // all results so far
+double maxWork = 3e8;           // inputs estimated to need more are skipped
+double minSeconds = 0.05;       // each measurement repeats for at least this long
+std::mt19937_64 engine( 1111514 );
+
+template< typename T >
+const char* typeName();
+
+// Times operation( i ) for i = 0, 1, ... until minSeconds have passed,
+// running prepare( i ) untimed before each, and records the result.
+template< typename Prepare, typename Operation >
+void measure( const char *operation, const char *type, const char *container, const char *input,
+              size_t numTerms, size_t numInputs, Prepare prepare, Operation operationOf );
+
+// Returns a polynomial of numTerms terms with distinct exponents in about
+// [ 0, spread ), coefficients in [ -coefBound, coefBound ] except a leading 1,
+// held in a Container of terms.
+template< typename T, typename Container = vector< Term< T > > >
+Polynomial< Container, T > randomPolynomial( size_t numTerms, long long spread, long long coefBound );
+
+// Returns the largest coefficient bound b for which sums of "numProducts"
+// products of two coefficients of magnitude at most b fit in T.
+template< typename T >
+long long coefficientBound( size_t numProducts );
+
+// Times the operations on the records of a .dat corpus of "recordTerms"
+// terms per record
+template< typename T >
+void benchmarkDat( const char *fileName, size_t recordTerms = 20 );
+
+template< typename T >
+void benchmarkRandom();
+
+// Times the operations on random polynomials whose terms are held in a
+// Container, labeled "name" in the report
+template< typename T, typename Container >
+void benchmarkContainer( const char *name );
+
+void writeJson( ostream &output );
+
+int main( int argc, char *argv[] )
+{
+   const char *jsonFileName = nullptr;
+   const char *datFileName = nullptr;
+   size_t recordTerms = 20;
+   for( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if( strcmp( argv[ i ], "--max-work" ) == 0 )
+         maxWork = atof( argv[ i + 1 ] );
+      else if( strcmp( argv[ i ], "--seed" ) == 0 )
+         engine.seed( strtoull( argv[ i + 1 ], nullptr, 10 ) );
+      else if( strcmp( argv[ i ], "--json" ) == 0 )
+         jsonFileName = argv[ i + 1 ];
+      else if( strcmp( argv[ i ], "--dat" ) == 0 )
+         datFileName = argv[ i + 1 ];
+      else if( strcmp( argv[ i ], "--record-terms" ) == 0 )
+         recordTerms = static_cast< size_t >( strtoull( argv[ i + 1 ], nullptr, 10 ) );
+   }
+
+   // measure the multiplication thresholds before anything is timed or counted
+   MultiplyDispatcher::prepare< vector< Term< long long > >, long long >();
+
+   cout << "operation       type       container input   terms     reps   ns/op          ns/term    allocs/op\n";
+
+   benchmarkDat< short >( "Polynomials - short.dat" );
+   benchmarkDat< long >( sizeof( long ) == 4 ? "Polynomials - long.dat" : "Polynomials - long long.dat" );
+   benchmarkDat< long long >( "Polynomials - long long.dat" );
+   if( datFileName != nullptr )
+      benchmarkDat< long long >( datFileName, recordTerms );
+
+   benchmarkRandom< short >();
+   benchmarkRandom< long >();
+   benchmarkRandom< long long >();
+
+   benchmarkContainer< long long, vector< Term< long long > > >( "vector" );
+   benchmarkContainer< long long, std::list< Term< long long > > >( "list" );
+   benchmarkContainer< long long, std::deque< Term< long long > > >( "deque" );
+   benchmarkContainer< long long, PackedTermVector< long long > >( "packed" );
+
+   if( jsonFileName != nullptr )
+   {
+      ofstream outFile( jsonFileName );
+      if( !outFile )
+      {
+         cout << "File could not be opened" << endl;
+         exit( 1 );
+      }
+      writeJson( outFile );
+   }
+   else
+      writeJson( cout );
+}
+
+template<>
+const char* typeName< short >()
+{
+   return "short";
+}
+
+template<>
+const char* typeName< long >()
+{
+   return "long";
+}
+
+template<>
+const char* typeName< long long >()
+{
+   return "long long";
+}
+
+template< typename Prepare, typename Operation >
+void measure( const char *operation, const char *type, const char *container, const char *input,
+              size_t numTerms, size_t numInputs, Prepare prepare, Operation operationOf )
+{
+   using clock = std::chrono::steady_clock;
+
+   double seconds = 0;
+   size_t allocations = 0;
+   size_t repetitions = 0;
+   while( repetitions == 0 || seconds < minSeconds )
+   {
+      size_t i = repetitions % numInputs;
+      prepare( i );
+
+      size_t allocationsBefore = numAllocations.load( std::memory_order_relaxed );
+      clock::time_point start = clock::now();
+      operationOf( i );
+      seconds += std::chrono::duration< double >( clock::now() - start ).count();
+      allocations += numAllocations.load( std::memory_order_relaxed ) - allocationsBefore;
+      repetitions++;
+   }
+
+   Result result;
+   result.operation = operation;
+   result.type = type;
+   result.container = container;
+   result.input = input;
+   result.numTerms = numTerms;
+   result.repetitions = repetitions;
+   result.nsPerOperation = seconds * 1e9 / repetitions;
+   result.nsPerTerm = numTerms > 0 ? result.nsPerOperation / numTerms : 0;
+   result.allocations = static_cast< double >( allocations ) / repetitions;
+   results.insert( results.end(), result );
+
+   char line[ 160 ];
+   snprintf( line, sizeof( line ), "%-15s %-10s %-9s %-7s %-9zu %-6zu %-14.1f %-10.2f %.1f\n",
+             operation, type, container, input, numTerms, repetitions,
+             result.nsPerOperation, result.nsPerTerm, result.allocations );
+   cout << line;
+}
+
+template< typename T, typename Container >
+Polynomial< Container, T > randomPolynomial( size_t numTerms, long long spread, long long coefBound )
+{
+   long long gap = spread / static_cast< long long >( numTerms > 0 ? numTerms : 1 );
+   if( gap < 1 )
+      gap = 1;
+
+   T *coefficients = new T[ numTerms ];
+   T *exponents = new T[ numTerms ];
+
+   // exponents grow from 0 by random gaps averaging about spread / numTerms
+   std::uniform_int_distribution< long long > gaps( 1, 2 * gap - 1 );
+   std::uniform_int_distribution< long long > coefs( -coefBound, coefBound );
+   long long expon = 0;
+   for( size_t i = numTerms; i-- > 0; )
+   {
+      exponents[ i ] = static_cast< T >( expon );
+      expon += gaps( engine );
+
+      long long coef = 0;
+      while( coef == 0 )
+         coef = coefs( engine );
+      coefficients[ i ] = static_cast< T >( coef );
+   }
+   if( numTerms > 0 )
+      coefficients[ 0 ] = 1;
+
+   Polynomial< Container, T > polynomial( numTerms );
+   polynomial.setPolynomial( coefficients, exponents, static_cast< int >( numTerms ) );
+
+   delete[] coefficients;
+   delete[] exponents;
+   return polynomial;
+}
+
+template< typename T >
+long long coefficientBound( size_t numProducts )
+{
+   double largest = static_cast< double >( std::numeric_limits< T >::max() );
+   long long bound = static_cast< long long >( sqrt( largest / ( 2.0 * ( numProducts > 0 ? numProducts : 1 ) ) ) );
+   return bound > 1 ? bound : 1;
+}
+
+template< typename T >
+void benchmarkDat( const char *fileName, size_t recordTerms )
+{
+   DatCorpusReader< T > corpus( fileName, recordTerms );
+   if( !corpus.isOpen() )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   size_t numRecords = corpus.size();
+   Poly< T > *polynomials = new Poly< T >[ numRecords ];
+   Poly< T > *roots = new Poly< T >[ numRecords ];
+   size_t numTerms = 0;
+   for( size_t i = 0; i < numRecords; i++ )
+   {
+      DatRecord< T > record = corpus[ i ];
+      Poly< T > polynomial( record.size() );
+      polynomial.setPolynomial( record.coefficients(), record.exponents(), static_cast< int >( record.size() ) );
+      polynomials[ i ] = polynomial;
+      roots[ i ] = polynomial.compSquareRoot();
+      numTerms += record.size();
+   }
+
+   size_t meanTerms = numRecords > 0 ? numTerms / numRecords : 0;
+   const char *type = typeName< T >();
+   Poly< T > sum;
+   Poly< T > result;
+
+   measure( "+=", type, "vector", "dat", 2 * meanTerms, numRecords,
+            [ & ]( size_t i ) { sum = polynomials[ i ]; },
+            [ & ]( size_t i ) { sum += polynomials[ ( i + 1 ) % numRecords ]; } );
+   measure( "*", type, "vector", "dat", 2 * meanTerms, numRecords, []( size_t ) {},
+            [ & ]( size_t i ) { result = polynomials[ i ] * polynomials[ ( i + 1 ) % numRecords ]; } );
+   measure( "square", type, "vector", "dat", meanTerms, numRecords, []( size_t ) {},
+            [ & ]( size_t i ) { result = polynomials[ i ].square(); } );
+   measure( "compSquareRoot", type, "vector", "dat", meanTerms, numRecords, []( size_t ) {},
+            [ & ]( size_t i ) { result = polynomials[ i ].compSquareRoot(); } );
+   measure( "verifySquare", type, "vector", "dat", meanTerms, numRecords, []( size_t ) {},
+            [ & ]( size_t i ) { verifySquare( roots[ i ], polynomials[ i ] ); } );
+
+   delete[] polynomials;
+   delete[] roots;
+}
+
+template< typename T >
+void benchmarkRandom()
+{
+   const char *type = typeName< T >();
+   double largestExponent = static_cast< double >( std::numeric_limits< T >::max() );
+
+   for( size_t n = 10; n <= 1000000; n *= 10 )
+   {
+      // exponents of products must fit in T too
+      long long spread = 4 * static_cast< long long >( n );
+      if( 2.0 * spread > largestExponent )
+         break;
+
+      Poly< T > a = randomPolynomial< T >( n, spread, coefficientBound< T >( n ) );
+      Poly< T > b = randomPolynomial< T >( n, spread, coefficientBound< T >( n ) );
+      Poly< T > sum;
+      Poly< T > result;
+      double terms = static_cast< double >( n );
+
+      if( terms <= maxWork )
+         measure( "+=", type, "vector", "random", 2 * n, 1,
+                  [ & ]( size_t ) { sum = a; },
+                  [ & ]( size_t ) { sum += b; } );
+      if( terms * terms <= maxWork )
+      {
+         measure( "*", type, "vector", "random", 2 * n, 1, []( size_t ) {},
+                  [ & ]( size_t ) { result = a * b; } );
+         measure( "square", type, "vector", "random", n, 1, []( size_t ) {},
+                  [ & ]( size_t ) { result = a.square(); } );
+      }
+
+      // a square of about n terms, from a root of k terms with few collisions
+      size_t k = static_cast< size_t >( sqrt( 2.0 * n ) );
+      long long rootSpread = static_cast< long long >( k ) * static_cast< long long >( k );
+      if( 2.0 * rootSpread > largestExponent || k < 2 )
+         continue;
+
+      Poly< T > root = randomPolynomial< T >( k, rootSpread, coefficientBound< T >( k ) );
+      Poly< T > square = root.square();
+
+      // every step of compSquareRoot subtracts from the whole remainder
+      if( static_cast< double >( k ) * square.size() <= maxWork )
+         measure( "compSquareRoot", type, "vector", "random", square.size(), 1, []( size_t ) {},
+                  [ & ]( size_t ) { result = square.compSquareRoot(); } );
+      if( static_cast< double >( square.size() ) <= maxWork )
+         measure( "verifySquare", type, "vector", "random", square.size(), 1, []( size_t ) {},
+                  [ & ]( size_t ) { verifySquare( root, square ); } );
+   }
+}
+
+template< typename T, typename Container >
+void benchmarkContainer( const char *name )
+{
+   using PolynomialType = Polynomial< Container, T >;
+   const char *type = typeName< T >();
+
+   for( size_t n = 100; n <= 10000; n *= 10 )
+   {
+      long long spread = 4 * static_cast< long long >( n );
+      PolynomialType a = randomPolynomial< T, Container >( n, spread, coefficientBound< T >( n ) );
+      PolynomialType b = randomPolynomial< T, Container >( n, spread, coefficientBound< T >( n ) );
+      PolynomialType sum;
+      PolynomialType result;
+      double terms = static_cast< double >( n );
+
+      if( terms <= maxWork )
+         measure( "+=", type, name, "random", 2 * n, 1,
+                  [ & ]( size_t ) { sum = a; },
+                  [ & ]( size_t ) { sum += b; } );
+      if( terms * terms <= maxWork )
+      {
+         measure( "*", type, name, "random", 2 * n, 1, []( size_t ) {},
+                  [ & ]( size_t ) { result = a * b; } );
+         measure( "square", type, name, "random", n, 1, []( size_t ) {},
+                  [ & ]( size_t ) { result = a.square(); } );
+      }
+
+      // every row is merged into a sum of up to 2 * spread terms
+      if( 2.0 * spread * terms <= maxWork )
+         measure( "multiplyRows", type, name, "random", 2 * n, 1, []( size_t ) {},
+                  [ & ]( size_t ) { result = a.multiplyRows( b ); } );
+
+      size_t k = static_cast< size_t >( sqrt( 2.0 * n ) );
+      long long rootSpread = static_cast< long long >( k ) * static_cast< long long >( k );
+      PolynomialType root = randomPolynomial< T, Container >( k, rootSpread, coefficientBound< T >( k ) );
+      PolynomialType square = root.square();
+      if( static_cast< double >( k ) * square.size() <= maxWork )
+         measure( "compSquareRoot", type, name, "random", square.size(), 1, []( size_t ) {},
+                  [ & ]( size_t ) { result = square.compSquareRoot(); } );
+   }
+}
+
+void writeJson( ostream &output )
+{
+   output << "[\n";
+   for( size_t i = 0; i < results.size(); i++ )
+   {
+      const Result &result = results[ i ];
+      char line[ 320 ];
+      snprintf( line, sizeof( line ),
+                "  { \"operation\": \"%s\", \"type\": \"%s\", \"container\": \"%s\", \"input\": \"%s\", "
+                "\"terms\": %zu, \"repetitions\": %zu, \"ns_per_op\": %.1f, \"ns_per_term\": %.3f, "
+                "\"allocs_per_op\": %.2f }%s\n",
+                result.operation, result.type, result.container, result.input, result.numTerms, result.repetitions,
+                result.nsPerOperation, result.nsPerTerm, result.allocations,
+                i + 1 < results.size() ? "," : "" );
+      output << line;
+   }
+   output << "]\n";
+}
\ No newline at end of file
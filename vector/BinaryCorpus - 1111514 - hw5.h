@@ -0,0 +1,455 @@
+// BinaryCorpus header
+// Compact, versioned binary format for polynomial corpora, with a writer and a
+// reader that maps the file and exposes records without copying them.
+//
+// Layout (integers in the byte order of the writer, little-endian in practice)
+//    header, 32 bytes:
+//       magic "PLYB", version (2 bytes), coefficient size (1 byte),
+//       1 reserved byte, number of records (8 bytes),
+//       offset of the index (8 bytes), 8 reserved bytes
+//    records, each starting at a multiple of 8:
+//       number of terms (4 bytes), length of the exponent stream (4 bytes),
+//       the coefficients as stored in memory (number of terms * coefficient size),
+//       the exponents: the first one as a zigzag varint, then the decrease
+//       from each exponent to the next as a varint,
+//       zero padding up to a multiple of 8
+//    index: the offset of every record, 8 bytes each
+
+#ifndef BINARYCORPUS_H
+#define BINARYCORPUS_H
+
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+using std::ostream;
+
+#include "MappedFile - 1111514 - hw5.h"
+#include "vector - 1111514 - hw5.h"
+
+template< typename T1, typename T2 >
+class Polynomial;
+
+// The fixed-size header at the start of a binary corpus
+struct BinaryCorpusHeader
+{
+   char magic[ 4 ];                // "PLYB"
+   unsigned short version;         // currently 1
+   unsigned char coefficientSize;  // sizeof the coefficient type
+   unsigned char reserved1;
+   unsigned long long numRecords;  // the number of polynomials
+   unsigned long long indexOffset; // where the index of record offsets starts
+   unsigned char reserved2[ 8 ];
+};
+
+static_assert( sizeof( BinaryCorpusHeader ) == 32, "BinaryCorpusHeader must be 32 bytes" );
+
+const unsigned short binaryCorpusVersion = 1;
+
+// Ends the program on a record that does not fit in the file or whose
+// exponent stream does not decode, since the corpus is corrupt.
+inline void binaryCorpusCorrupt()
+{
+   std::cout << "corrupt polynomial corpus\n";
+   exit( 1 );
+}
+
+// CLASS TEMPLATE VarintExponentIterator
+// Decodes the exponent stream of a record one exponent at a time. A varint
+// that runs past the end of the stream, or past the 10 bytes a 64-bit value
+// needs, ends the program as a corrupt corpus.
+template< typename E >
+class VarintExponentIterator
+{
+public:
+   using value_type = E;
+   using difference_type = ptrdiff_t;
+   using pointer = const E *;
+   using reference = const E &;
+   using iterator_category = std::input_iterator_tag;
+
+   // Constructs an end iterator.
+   VarintExponentIterator()
+      : next( nullptr ),
+        last( nullptr ),
+        remaining( 0 ),
+        current( 0 )
+   {
+   }
+
+   // Constructs an iterator over "numTerms" exponents encoded in the bytes
+   // [ stream, streamEnd ).
+   VarintExponentIterator( const unsigned char *stream, const unsigned char *streamEnd, size_t numTerms )
+      : next( stream ),
+        last( streamEnd ),
+        remaining( numTerms ),
+        current( 0 )
+   {
+      if( remaining > 0 )
+      {
+         unsigned long long zigzag = decode();
+         current = static_cast< long long >( ( zigzag >> 1 ) ^ ( 0 - ( zigzag & 1 ) ) );
+      }
+   }
+
+   E operator*() const
+   {
+      return static_cast< E >( current );
+   }
+
+   VarintExponentIterator& operator++() // preincrement
+   {
+      if( --remaining > 0 )
+         current = static_cast< long long >( static_cast< unsigned long long >( current ) - decode() );
+      return *this;
+   }
+
+   VarintExponentIterator operator++( int ) // postincrement
+   {
+      VarintExponentIterator tmp = *this;
+      ++*this;
+      return tmp;
+   }
+
+   // Iterators are equal if they have as many exponents left.
+   bool operator==( const VarintExponentIterator &right ) const
+   {
+      return remaining == right.remaining;
+   }
+
+   bool operator!=( const VarintExponentIterator &right ) const
+   {
+      return remaining != right.remaining;
+   }
+
+private:
+   const unsigned char *next; // the next undecoded byte
+   const unsigned char *last; // the end of the exponent stream
+   size_t remaining;          // the number of exponents left, including current
+   long long current;         // the current exponent
+
+   // Decodes one LEB128 varint of at most 10 bytes, the last of which may
+   // only hold the top bit of the value.
+   unsigned long long decode()
+   {
+      unsigned long long value = 0;
+      int shift = 0;
+      unsigned char byte;
+      do
+      {
+         if( next == last || ( shift == 63 && *next > 1 ) )
+            binaryCorpusCorrupt();
+         byte = *next++;
+         value |= static_cast< unsigned long long >( byte & 0x7F ) << shift;
+         shift += 7;
+      } while( ( byte & 0x80 ) != 0 );
+
+      return value;
+   }
+}; // end class template VarintExponentIterator
+
+// CLASS TEMPLATE BinaryRecord
+// One polynomial of a mapped corpus; the coefficients are read in place.
+template< typename T, typename E >
+class BinaryRecord
+{
+public:
+   BinaryRecord( const T *coefficientData, const unsigned char *exponentData,
+                 const unsigned char *exponentDataEnd, size_t count )
+      : myCoefficients( coefficientData ),
+        myExponents( exponentData ),
+        myExponentsEnd( exponentDataEnd ),
+        numTerms( count )
+   {
+   }
+
+   // Returns the number of terms.
+   size_t size() const
+   {
+      return numTerms;
+   }
+
+   // Returns the coefficients, by decreasing exponent, inside the mapping.
+   const T* coefficients() const
+   {
+      return myCoefficients;
+   }
+
+   // Returns an iterator over the exponents, by decreasing exponent.
+   VarintExponentIterator< E > exponents() const
+   {
+      return VarintExponentIterator< E >( myExponents, myExponentsEnd, numTerms );
+   }
+
+   // Returns the iterator one past the last exponent.
+   VarintExponentIterator< E > exponentsEnd() const
+   {
+      return VarintExponentIterator< E >();
+   }
+
+private:
+   const T *myCoefficients;             // numTerms coefficients
+   const unsigned char *myExponents;    // the encoded exponent stream
+   const unsigned char *myExponentsEnd; // the end of the stream
+   size_t numTerms;                     // the number of terms
+}; // end class template BinaryRecord
+
+// CLASS TEMPLATE BinaryCorpusReader
+// Maps a binary corpus whose coefficients have type T.
+template< typename T >
+class BinaryCorpusReader
+{
+public:
+   using exponent_type = T;
+   using record_type = BinaryRecord< T, exponent_type >;
+
+   BinaryCorpusReader()
+      : numRecords( 0 ),
+        index( nullptr )
+   {
+   }
+
+   // Maps and checks the corpus named "fileName"; check isOpen() afterwards.
+   explicit BinaryCorpusReader( const char *fileName )
+      : BinaryCorpusReader()
+   {
+      open( fileName );
+   }
+
+   // Maps the corpus named "fileName". Returns false, and maps nothing, if the
+   // file is missing, is not a version 1 corpus, stores coefficients of a
+   // different size or has an index that does not fit in the file.
+   bool open( const char *fileName )
+   {
+      numRecords = 0;
+      index = nullptr;
+      if( !file.open( fileName ) )
+         return false;
+
+      BinaryCorpusHeader header;
+      if( file.size() < sizeof( header ) )
+         return fail();
+      memcpy( &header, file.data(), sizeof( header ) );
+
+      if( memcmp( header.magic, "PLYB", 4 ) != 0 || header.version != binaryCorpusVersion ||
+          header.coefficientSize != sizeof( T ) || header.indexOffset % 8 != 0 ||
+          header.indexOffset > file.size() ||
+          header.numRecords > ( file.size() - header.indexOffset ) / 8 )
+         return fail();
+
+      numRecords = static_cast< size_t >( header.numRecords );
+      index = reinterpret_cast< const unsigned long long * >( file.data() + header.indexOffset );
+      return true;
+   }
+
+   bool isOpen() const
+   {
+      return file.isOpen();
+   }
+
+   // Returns the number of records.
+   size_t size() const
+   {
+      return numRecords;
+   }
+
+   // Returns record i. A record that does not fit in the file ends the program,
+   // since the corpus is corrupt; its exponents are checked as they are decoded.
+   record_type operator[]( size_t i ) const
+   {
+      if( i >= numRecords )
+      {
+         std::cout << "corpus record out of range\n";
+         exit( 1 );
+      }
+
+      unsigned long long offset = index[ i ];
+      const unsigned char *base = file.data();
+      unsigned int counts[ 2 ] = {}; // number of terms, exponent bytes
+      if( offset % 8 != 0 || offset > file.size() || file.size() - offset < sizeof( counts ) )
+         binaryCorpusCorrupt();
+      memcpy( counts, base + offset, sizeof( counts ) );
+
+      unsigned long long end = offset + sizeof( counts ) +
+                               static_cast< unsigned long long >( counts[ 0 ] ) * sizeof( T ) + counts[ 1 ];
+      if( end > file.size() )
+         binaryCorpusCorrupt();
+
+      const unsigned char *coefficients = base + offset + sizeof( counts );
+      return record_type( reinterpret_cast< const T * >( coefficients ),
+                          coefficients + counts[ 0 ] * sizeof( T ), base + end, counts[ 0 ] );
+   }
+
+private:
+   MappedFile file;                     // the mapped corpus
+   size_t numRecords;                   // the number of records
+   const unsigned long long *index;     // the offsets of the records
+
+   bool fail()
+   {
+      file.close();
+      return false;
+   }
+}; // end class template BinaryCorpusReader
+
+// CLASS TEMPLATE BinaryCorpusWriter
+// Streams polynomials with coefficients of type T into a binary corpus.
+// The stream must be opened in binary mode and be seekable, because finish()
+// writes the header last.
+template< typename T >
+class BinaryCorpusWriter
+{
+   static_assert( std::is_integral< T >::value, "binary corpora store integral coefficients" );
+
+public:
+   explicit BinaryCorpusWriter( ostream &outStream )
+      : output( outStream ),
+        start( outStream.tellp() ),
+        position( sizeof( BinaryCorpusHeader ) ),
+        buffer( nullptr ),
+        capacity( 0 ),
+        finished( false )
+   {
+      BinaryCorpusHeader header = {};
+      output.write( reinterpret_cast< const char * >( &header ), sizeof( header ) );
+   }
+
+   BinaryCorpusWriter( const BinaryCorpusWriter & ) = delete;
+   BinaryCorpusWriter& operator=( const BinaryCorpusWriter & ) = delete;
+
+   // Finishes the corpus if finish() has not been called.
+   ~BinaryCorpusWriter()
+   {
+      finish();
+      delete[] buffer;
+   }
+
+   // Appends a polynomial given as numTerms coefficients and exponents,
+   // both by decreasing exponent. Returns false, writing nothing, if the
+   // record's counts do not fit their 4-byte fields.
+   template< typename CoefIterator, typename ExponIterator >
+   bool write( CoefIterator coefficient, ExponIterator exponent, size_t numTerms )
+   {
+      if( numTerms > UINT_MAX )
+         return false;
+
+      // counts, coefficients, at most 10 bytes per exponent, padding
+      size_t bound = 8 + numTerms * ( sizeof( T ) + 10 ) + 8;
+      if( bound > capacity )
+      {
+         delete[] buffer;
+         capacity = bound > 2 * capacity ? bound : 2 * capacity;
+         buffer = new unsigned char[ capacity ];
+      }
+
+      unsigned char *coefficients = buffer + 8;
+      unsigned char *exponents = coefficients + numTerms * sizeof( T );
+      unsigned char *next = exponents;
+      long long previous = 0;
+      for( size_t i = 0; i < numTerms; ++i, ++coefficient, ++exponent )
+      {
+         T coef = static_cast< T >( *coefficient );
+         memcpy( coefficients + i * sizeof( T ), &coef, sizeof( T ) );
+
+         long long expon = static_cast< long long >( *exponent );
+         if( i == 0 )
+            next = encode( next, ( static_cast< unsigned long long >( expon ) << 1 ) ^
+                                 static_cast< unsigned long long >( expon >> 63 ) );
+         else
+            next = encode( next, static_cast< unsigned long long >( previous ) -
+                                 static_cast< unsigned long long >( expon ) );
+         previous = expon;
+      }
+
+      if( static_cast< size_t >( next - exponents ) > UINT_MAX )
+         return false;
+
+      unsigned int counts[ 2 ] = { static_cast< unsigned int >( numTerms ),
+                                   static_cast< unsigned int >( next - exponents ) };
+      memcpy( buffer, counts, sizeof( counts ) );
+      while( ( next - buffer ) % 8 != 0 )
+         *next++ = 0;
+
+      offsets.insert( offsets.end(), position );
+      output.write( reinterpret_cast< const char * >( buffer ), next - buffer );
+      position += static_cast< unsigned long long >( next - buffer );
+      return true;
+   }
+
+   // Appends a polynomial; returns false as the other write does.
+   template< typename T1 >
+   bool write( const Polynomial< T1, T > &a )
+   {
+      using TermIterator = decltype( a.begin() );
+      TermCoefficients< TermIterator > coefficients{ a.begin() };
+      TermExponents< TermIterator > exponents{ a.begin() };
+      return write( coefficients, exponents, a.size() );
+   }
+
+   // Writes the index and the header. Nothing may be written afterwards.
+   void finish()
+   {
+      if( finished )
+         return;
+      finished = true;
+
+      if( !offsets.empty() )
+         output.write( reinterpret_cast< const char * >( &offsets.front() ),
+                       offsets.size() * sizeof( unsigned long long ) );
+
+      BinaryCorpusHeader header = {};
+      memcpy( header.magic, "PLYB", 4 );
+      header.version = binaryCorpusVersion;
+      header.coefficientSize = sizeof( T );
+      header.numRecords = offsets.size();
+      header.indexOffset = position;
+
+      std::streampos end = output.tellp();
+      output.seekp( start );
+      output.write( reinterpret_cast< const char * >( &header ), sizeof( header ) );
+      output.seekp( end );
+      output.flush();
+   }
+
+private:
+   ostream &output;                     // the destination stream
+   std::streampos start;                // where the header is
+   unsigned long long position;         // offset of the next record
+   vector< unsigned long long > offsets; // offsets of the records written
+   unsigned char *buffer;               // holds one encoded record
+   size_t capacity;                     // the size of buffer
+   bool finished;                       // true once finish() has run
+
+   // Walks the coefficients of a polynomial's terms for write( CoefIterator, ... ).
+   template< typename TermIterator >
+   struct TermCoefficients
+   {
+      TermIterator it;
+      T operator*() const { return ( *it ).coef; }
+      TermCoefficients& operator++() { ++it; return *this; }
+   };
+
+   // Walks the exponents of a polynomial's terms for write( ..., ExponIterator, ... ).
+   template< typename TermIterator >
+   struct TermExponents
+   {
+      TermIterator it;
+      long long operator*() const { return ( *it ).expon; }
+      TermExponents& operator++() { ++it; return *this; }
+   };
+
+   // Writes "value" as a LEB128 varint at "next" and returns the byte after it.
+   static unsigned char* encode( unsigned char *next, unsigned long long value )
+   {
+      while( value >= 0x80 )
+      {
+         *next++ = static_cast< unsigned char >( value | 0x80 );
+         value >>= 7;
+      }
+      *next++ = static_cast< unsigned char >( value );
+      return next;
+   }
+}; // end class template BinaryCorpusWriter
+
+#endif // BINARYCORPUS_H
\ No newline at end of file
@@ -0,0 +1,204 @@
+// DatCorpus header
+// Maps a whole "Polynomials - *.dat" file and exposes its records in place.
+//
+// Every record holds "recordTerms" coefficients followed by "recordTerms"
+// exponents, all of type T, by decreasing exponent; the unused trailing terms
+// have zero coefficients. The shipped files have arraySize = 20 terms per
+// record; files written with Generator's --record-terms have longer records,
+// whose length is given when they are opened.
+
+#ifndef DATCORPUS_H
+#define DATCORPUS_H
+
+#include <cstddef>
+#include <iterator>
+
+#include "MappedFile - 1111514 - hw5.h"
+
+// CLASS TEMPLATE DatRecord
+// One polynomial of a mapped .dat file.
+template< typename T >
+class DatRecord
+{
+public:
+   DatRecord( const T *coefficientData, const T *exponentData, size_t count )
+      : myCoefficients( coefficientData ),
+        myExponents( exponentData ),
+        numTerms( count )
+   {
+   }
+
+   // Returns the number of terms, without the zero padding.
+   size_t size() const
+   {
+      return numTerms;
+   }
+
+   // Returns the coefficients inside the mapping.
+   const T* coefficients() const
+   {
+      return myCoefficients;
+   }
+
+   // Returns the exponents inside the mapping.
+   const T* exponents() const
+   {
+      return myExponents;
+   }
+
+private:
+   const T *myCoefficients; // numTerms coefficients
+   const T *myExponents;    // numTerms exponents
+   size_t numTerms;         // the number of terms
+}; // end class template DatRecord
+
+// CLASS TEMPLATE DatCorpusReader
+// arraySize is the record length used unless another is given to open().
+template< typename T, int arraySize = 20 >
+class DatCorpusReader
+{
+public:
+   // CLASS const_iterator
+   // Walks the records in file order.
+   class const_iterator
+   {
+   public:
+      using value_type = DatRecord< T >;
+      using difference_type = ptrdiff_t;
+      using pointer = void;
+      using reference = DatRecord< T >;
+      using iterator_category = std::input_iterator_tag;
+
+      const_iterator( const DatCorpusReader *corpus, size_t index )
+         : myCorpus( corpus ),
+           myIndex( index )
+      {
+      }
+
+      DatRecord< T > operator*() const
+      {
+         return ( *myCorpus )[ myIndex ];
+      }
+
+      const_iterator& operator++() // preincrement
+      {
+         ++myIndex;
+         return *this;
+      }
+
+      const_iterator operator++( int ) // postincrement
+      {
+         const_iterator tmp = *this;
+         ++myIndex;
+         return tmp;
+      }
+
+      bool operator==( const const_iterator &right ) const
+      {
+         return myIndex == right.myIndex;
+      }
+
+      bool operator!=( const const_iterator &right ) const
+      {
+         return myIndex != right.myIndex;
+      }
+
+   private:
+      const DatCorpusReader *myCorpus; // the corpus walked
+      size_t myIndex;                  // the current record
+   }; // end class const_iterator
+
+   DatCorpusReader()
+      : numRecords( 0 ),
+        numRecordTerms( arraySize )
+   {
+   }
+
+   // Maps the file named "fileName", of "terms" terms per record; check
+   // isOpen() afterwards.
+   explicit DatCorpusReader( const char *fileName, size_t terms = arraySize )
+      : DatCorpusReader()
+   {
+      open( fileName, terms );
+   }
+
+   // Maps the file named "fileName", of "terms" terms per record. Returns
+   // false, and maps nothing, if "terms" is 0, the file cannot be mapped or
+   // its size is not a multiple of recordSize(), which means it was written
+   // for coefficients of another size or records of another length.
+   bool open( const char *fileName, size_t terms = arraySize )
+   {
+      numRecords = 0;
+      numRecordTerms = terms;
+      if( terms == 0 || !file.open( fileName ) )
+         return false;
+
+      if( file.size() % recordSize() != 0 )
+      {
+         file.close();
+         return false;
+      }
+
+      numRecords = file.size() / recordSize();
+      return true;
+   }
+
+   bool isOpen() const
+   {
+      return file.isOpen();
+   }
+
+   // Returns the number of records.
+   size_t size() const
+   {
+      return numRecords;
+   }
+
+   // Returns the number of terms per record, padding included.
+   size_t recordTerms() const
+   {
+      return numRecordTerms;
+   }
+
+   // Returns the number of bytes per record.
+   size_t recordSize() const
+   {
+      return 2 * numRecordTerms * sizeof( T );
+   }
+
+   // Returns record i; the file is only read here, through the mapping.
+   DatRecord< T > operator[]( size_t i ) const
+   {
+      return record( reinterpret_cast< const T * >( file.data() + i * recordSize() ), numRecordTerms );
+   }
+
+   // Returns the record of "terms" terms stored at "data", wherever it was read to.
+   static DatRecord< T > record( const T *data, size_t terms = arraySize )
+   {
+      const T *coefficients = data;
+      const T *exponents = coefficients + terms;
+
+      size_t numTerms = terms;
+      while( numTerms > 0 && coefficients[ numTerms - 1 ] == 0 )
+         numTerms--;
+
+      return DatRecord< T >( coefficients, exponents, numTerms );
+   }
+
+   const_iterator begin() const
+   {
+      return const_iterator( this, 0 );
+   }
+
+   const_iterator end() const
+   {
+      return const_iterator( this, numRecords );
+   }
+
+private:
+   MappedFile file;       // the mapped file
+   size_t numRecords;     // the number of records
+   size_t numRecordTerms; // the number of terms per record
+}; // end class template DatCorpusReader
+
+#endif // DATCORPUS_H
\ No newline at end of file
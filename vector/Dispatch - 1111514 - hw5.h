@@ -0,0 +1,269 @@
+// Dispatch header
+// Chooses how Polynomial multiplies: by folding rows, as dense coefficient
+// arrays, through a hash table, or on the threads of the shared pool. The
+// choice depends on crossover thresholds that differ from machine to
+// machine, so they are measured once per program by a short benchmark, or
+// read from a profile file saved earlier. Programs that time their products
+// call MultiplyDispatcher::prepare() at startup, so the first product does not
+// pay for the benchmark.
+//
+// If the environment variable POLYNOMIAL_PROFILE names a file, the
+// thresholds are loaded from it; when it cannot be read they are measured
+// and saved to it, so later runs on the same machine skip the benchmark.
+
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+
+#include "ThreadPool - 1111514 - hw5.h"
+
+template< typename T >
+struct Term;
+
+template< typename T1, typename T2 >
+class Polynomial;
+
+// The ways Polynomial can multiply
+enum class MultiplyStrategy
+{
+   Rows,     // fold the rows of the product into a sum, as operator* always did
+   Dense,    // convolve arrays of coefficients; see multiplyDense
+   Hashed,   // accumulate products by exponent; see multiplyHashed
+   Parallel  // accumulate bands of exponents on every thread; see multiplyParallel
+};
+
+// Crossover points between the strategies
+struct MultiplyThresholds
+{
+   size_t rowPairs = 64;                        // fold rows up to this many term pairs
+   size_t denseRatio = 2;                       // dense: a term in every denseRatio exponents
+   size_t parallelPairs = size_t( 1 ) << 20;    // use the pool above this many term pairs
+
+   // The largest denseRatio calibrate() tries; a larger one would call
+   // operands dense whose coefficient arrays are mostly zeros
+   static const size_t maxDenseRatio = 32;
+
+   // Reads "name value" lines from "fileName"; names not in the file keep
+   // their values, and denseRatio is clamped to [ 1, maxDenseRatio ].
+   // Returns false if the file cannot be read.
+   bool load( const char *fileName )
+   {
+      std::ifstream inFile( fileName );
+      if( !inFile )
+         return false;
+
+      std::string name;
+      unsigned long long value;
+      while( inFile >> name >> value )
+         if( name == "rowPairs" )
+            rowPairs = static_cast< size_t >( value );
+         else if( name == "denseRatio" && value > 0 )
+            denseRatio = static_cast< size_t >( value < maxDenseRatio ? value : maxDenseRatio );
+         else if( name == "parallelPairs" )
+            parallelPairs = static_cast< size_t >( value );
+
+      return true;
+   }
+
+   // Writes the thresholds to "fileName" as load() reads them.
+   bool save( const char *fileName ) const
+   {
+      std::ofstream outFile( fileName );
+      outFile << "rowPairs " << rowPairs << '\n'
+              << "denseRatio " << denseRatio << '\n'
+              << "parallelPairs " << parallelPairs << '\n';
+      return static_cast< bool >( outFile );
+   }
+};
+
+// CLASS MultiplyDispatcher
+class MultiplyDispatcher
+{
+public:
+   // Returns the strategy for a product of "pairs" term pairs; "dense" tells
+   // whether both operands are dense by thresholds.denseRatio.
+   static MultiplyStrategy choose( const MultiplyThresholds &thresholds, size_t pairs, bool dense )
+   {
+      if( pairs <= thresholds.rowPairs )
+         return MultiplyStrategy::Rows;
+      if( dense )
+         return MultiplyStrategy::Dense;
+      if( pairs > thresholds.parallelPairs && ThreadPool::shared().size() > 1 )
+         return MultiplyStrategy::Parallel;
+      return MultiplyStrategy::Hashed;
+   }
+
+   // Returns the thresholds in use, preparing them with Polynomial< T1, T2 >
+   // if nothing has prepared them yet.
+   template< typename T1, typename T2 >
+   static const MultiplyThresholds& thresholds()
+   {
+      prepare< T1, T2 >();
+      return current();
+   }
+
+   // Loads or measures the thresholds, with Polynomial< T1, T2 >, unless they
+   // have been prepared already. Only the first call does anything; its type
+   // stands for every polynomial type in the program. calibrate() must not
+   // call this, or it would wait for itself.
+   template< typename T1, typename T2 >
+   static void prepare()
+   {
+      std::call_once( prepared(), []
+      {
+         std::string fileName = profileName();
+         if( fileName.empty() || !current().load( fileName.c_str() ) )
+         {
+            current() = calibrate< T1, T2 >();
+            if( !fileName.empty() )
+               current().save( fileName.c_str() );
+         }
+      } );
+   }
+
+   // Measures the thresholds for Polynomial< T1, T2 > on this machine.
+   // Each crossover is the point where the next strategy first beats the one
+   // before it on random operands; it takes some tens of milliseconds.
+   template< typename T1, typename T2 >
+   static MultiplyThresholds calibrate()
+   {
+      using PolynomialType = Polynomial< T1, T2 >;
+      MultiplyThresholds result;
+
+      // rows against the hash table, on sparse operands of n terms each
+      const size_t rowSizes[] = { 2, 3, 4, 6, 8, 11, 16, 23, 32, 45, 64 };
+      for( size_t n : rowSizes )
+      {
+         PolynomialType a = randomOperand< T1, T2 >( n, 1000 * n );
+         PolynomialType b = randomOperand< T1, T2 >( n, 1000 * n );
+         double rows = secondsPerCall( [ & ] { a.multiplyRows( b ); } );
+         double hashed = secondsPerCall( [ & ] { a.multiplyHashed( b ); } );
+         if( hashed < rows )
+            break;
+         result.rowPairs = n * n;
+      }
+
+      // dense arrays against the hash table, as the gaps between exponents grow
+      const size_t n = 256;
+      result.denseRatio = 1;
+      for( size_t ratio = 1; ratio <= MultiplyThresholds::maxDenseRatio; ratio *= 2 )
+      {
+         PolynomialType a = randomOperand< T1, T2 >( n, n * ratio );
+         PolynomialType b = randomOperand< T1, T2 >( n, n * ratio );
+         double dense = secondsPerCall( [ & ] { a.multiplyDense( b ); } );
+         double hashed = secondsPerCall( [ & ] { a.multiplyHashed( b ); } );
+         if( hashed < dense )
+            break;
+         result.denseRatio = ratio;
+      }
+
+      // the pool against one thread; tasks cannot use the pool in parallel
+      ThreadPool &pool = ThreadPool::shared();
+      if( pool.size() > 1 && !ThreadPool::calledFromTask() )
+      {
+         result.parallelPairs = 0;
+         const size_t parallelSizes[] = { 64, 128, 256, 512, 1024, 2048 };
+         for( size_t size : parallelSizes )
+         {
+            PolynomialType a = randomOperand< T1, T2 >( size, 1000 * size );
+            PolynomialType b = randomOperand< T1, T2 >( size, 1000 * size );
+            double parallel = secondsPerCall( [ & ] { a.multiplyParallel( b, pool ); } );
+            double hashed = secondsPerCall( [ & ] { a.multiplyHashed( b ); } );
+            if( parallel < hashed )
+               break;
+            result.parallelPairs = size * size;
+         }
+      }
+
+      return result;
+   }
+
+private:
+   static MultiplyThresholds& current()
+   {
+      static MultiplyThresholds thresholds;
+      return thresholds;
+   }
+
+   // Guards current(), which is written once by the first prepare()
+   static std::once_flag& prepared()
+   {
+      static std::once_flag once;
+      return once;
+   }
+
+   // Returns the value of POLYNOMIAL_PROFILE, or "" if it is not set
+   static std::string profileName()
+   {
+#if defined( _MSC_VER )
+      char *value = nullptr;
+      size_t length = 0;
+      std::string name;
+      if( _dupenv_s( &value, &length, "POLYNOMIAL_PROFILE" ) == 0 && value != nullptr )
+         name = value;
+      free( value );
+      return name;
+#else
+      const char *value = std::getenv( "POLYNOMIAL_PROFILE" );
+      return value != nullptr ? value : "";
+#endif
+   }
+
+   // Returns the mean time of a call of f, over calls that take at least a
+   // millisecond in all
+   template< typename Function >
+   static double secondsPerCall( Function f )
+   {
+      using Clock = std::chrono::steady_clock;
+      size_t calls = 0;
+      Clock::time_point start = Clock::now();
+      double seconds;
+      do
+      {
+         f();
+         calls++;
+         seconds = std::chrono::duration< double >( Clock::now() - start ).count();
+      } while( seconds < 1e-3 );
+
+      return seconds / calls;
+   }
+
+   // Returns a polynomial of "n" terms with small coefficients and distinct
+   // exponents spread over [ 0, span ), or less if the exponent type is narrow
+   template< typename T1, typename T2 >
+   static Polynomial< T1, T2 > randomOperand( size_t n, size_t span )
+   {
+      // products double the exponents, which must still fit their type
+      using Exponent = typename Term< T2 >::exponent_type;
+      size_t largest = static_cast< size_t >( std::numeric_limits< Exponent >::max() / 2 );
+      if( span > largest )
+         span = largest;
+
+      unsigned long long seed = 1111514;
+      long long *coefficients = new long long[ n ];
+      long long *exponents = new long long[ n ];
+
+      // exponents[ i ] is drawn from the i-th of n equal slices of the span
+      size_t slice = span / n > 0 ? span / n : 1;
+      for( size_t i = 0; i < n; i++ )
+      {
+         seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+         coefficients[ i ] = static_cast< long long >( seed >> 62 ) + 1;
+         exponents[ i ] = static_cast< long long >( ( n - 1 - i ) * slice + ( seed >> 33 ) % slice );
+      }
+
+      Polynomial< T1, T2 > polynomial( n );
+      polynomial.setPolynomial( coefficients, exponents, static_cast< int >( n ) );
+      delete[] coefficients;
+      delete[] exponents;
+      return polynomial;
+   }
+}; // end class MultiplyDispatcher
+
+#endif // DISPATCH_H
\ No newline at end of file
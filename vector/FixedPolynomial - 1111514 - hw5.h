@@ -0,0 +1,324 @@
+// FixedPolynomial header
+// A polynomial of at most Capacity terms held in a std::array, with every
+// operation constexpr, for small polynomials known in advance: constant
+// tables, test fixtures and precomputed squares are built by the compiler
+// and need no allocation or setup at run time. The operations follow those
+// of Polynomial: sums merge term lists, products fold one row per term, and
+// squareRoot takes the steps of compSquareRoot. Loops run over at most
+// Capacity terms, so the optimizer sees every shape statically.
+// Include a Polynomial header before this one; it defines Term.
+
+#ifndef FIXEDPOLYNOMIAL_H
+#define FIXEDPOLYNOMIAL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <type_traits>
+
+template< typename T >
+struct Term;
+
+// CLASS TEMPLATE FixedPolynomial
+// Terms are kept by decreasing exponent with nonzero coefficients, as in
+// Polynomial. An operation whose result has more than Capacity terms stops
+// the program, or fails to compile when evaluated by the compiler.
+template< typename T, size_t Capacity >
+class FixedPolynomial
+{
+   static_assert( std::is_integral< T >::value, "fixed polynomials have integer coefficients" );
+
+public:
+   using exponent_type = typename Term< T >::exponent_type;
+
+   // Constructs the zero polynomial, with no terms.
+   constexpr FixedPolynomial()
+      : terms{},
+        mySize( 0 )
+   {
+   }
+
+   // Constructs the sum of "list", such as { { 3, 4 }, { -2, 1 }, { 1, 0 } }
+   // for 3x^4 - 2x + 1, in any order of exponents.
+   constexpr FixedPolynomial( std::initializer_list< Term< T > > list )
+      : terms{},
+        mySize( 0 )
+   {
+      for( const Term< T > &term : list )
+      {
+         FixedPolynomial monomial;
+         monomial.attach( term.coef, term.expon );
+         *this += monomial;
+      }
+   }
+
+   constexpr bool operator==( const FixedPolynomial &right ) const
+   {
+      if( mySize != right.mySize )
+         return false;
+
+      for( size_t i = 0; i < mySize; i++ )
+         if( terms[ i ].coef != right.terms[ i ].coef || terms[ i ].expon != right.terms[ i ].expon )
+            return false;
+      return true;
+   }
+
+   constexpr bool operator!=( const FixedPolynomial &right ) const
+   {
+      return !( *this == right );
+   }
+
+   constexpr void operator+=( const FixedPolynomial &op2 )
+   {
+      mergeTerms( op2, []( const Term< T > &term ) { return term; } );
+   }
+
+   constexpr void operator-=( const FixedPolynomial &op2 )
+   {
+      mergeTerms( op2, []( const Term< T > &term )
+      {
+         Term< T > minus{};
+         minus.coef = -term.coef;
+         minus.expon = term.expon;
+         return minus;
+      } );
+   }
+
+   constexpr FixedPolynomial operator+( const FixedPolynomial &op2 ) const
+   {
+      FixedPolynomial sum = *this;
+      sum += op2;
+      return sum;
+   }
+
+   constexpr FixedPolynomial operator-( const FixedPolynomial &op2 ) const
+   {
+      FixedPolynomial difference = *this;
+      difference -= op2;
+      return difference;
+   }
+
+   // Adds the row terms[ i ] * op2 to the product for every term, as
+   // Polynomial::multiplyRows does
+   constexpr FixedPolynomial operator*( const FixedPolynomial &op2 ) const
+   {
+      FixedPolynomial product;
+      for( size_t i = 0; i < mySize; i++ )
+         product.addProduct( terms[ i ], op2 );
+      return product;
+   }
+
+   constexpr FixedPolynomial square() const
+   {
+      return *this * *this;
+   }
+
+   // Returns the square root, found as compSquareRoot finds it: every step
+   // divides the leading term of the remainder by twice the root's leading
+   // term and subtracts the new term times the doubled root so far.
+   constexpr FixedPolynomial squareRoot() const
+   {
+      FixedPolynomial remainder = *this;
+      FixedPolynomial root;
+      FixedPolynomial divisor;
+      if( remainder.zero() )
+         return root;
+
+      Term< T > monomial{};
+      monomial.coef = integerSquareRoot( remainder.terms[ 0 ].coef );
+      monomial.expon = remainder.terms[ 0 ].expon / 2;
+      root.attach( monomial.coef, monomial.expon );
+      divisor.attach( monomial.coef, monomial.expon );
+      Term< T > minus{};
+      minus.coef = -monomial.coef;
+      minus.expon = monomial.expon;
+      remainder.addProduct( minus, root );
+
+      // the leading term of divisor is fixed once it has been doubled
+      T leading = monomial.coef + monomial.coef;
+      while( !remainder.zero() )
+      {
+         divisor.terms[ divisor.mySize - 1 ].coef *= 2;
+         monomial.coef = remainder.terms[ 0 ].coef / leading;
+         monomial.expon = remainder.terms[ 0 ].expon - divisor.terms[ 0 ].expon;
+         if( monomial.coef == 0 )
+            fail( "FixedPolynomial square root of a polynomial that is not a perfect square" );
+
+         root.attach( monomial.coef, monomial.expon );
+         divisor.attach( monomial.coef, monomial.expon );
+         minus.coef = -monomial.coef;
+         minus.expon = monomial.expon;
+         remainder.addProduct( minus, divisor );
+      }
+
+      return root;
+   }
+
+   // Returns the value at x
+   constexpr T evaluate( T x ) const
+   {
+      T result = 0;
+      for( size_t i = 0; i < mySize; i++ )
+      {
+         // Horner's rule, stepping over the gaps between exponents
+         if( i > 0 )
+            result *= power( x, terms[ i - 1 ].expon - terms[ i ].expon );
+         result += terms[ i ].coef;
+      }
+
+      if( !zero() )
+         result *= power( x, terms[ mySize - 1 ].expon );
+      return result;
+   }
+
+   // Returns the highest of degrees of the terms
+   constexpr exponent_type degree() const
+   {
+      return zero() ? 0 : terms[ 0 ].expon;
+   }
+
+   // Returns the number of terms
+   constexpr size_t size() const
+   {
+      return mySize;
+   }
+
+   // Returns term i, counting from the highest exponent
+   constexpr Term< T > term( size_t i ) const
+   {
+      return terms[ i ];
+   }
+
+   constexpr bool zero() const
+   {
+      return mySize == 0;
+   }
+
+   // Returns a copy as a PolynomialType, such as Polynomial< vector< Term< T > >, T >
+   template< typename PolynomialType >
+   PolynomialType toPolynomial() const
+   {
+      T coefficients[ Capacity > 0 ? Capacity : 1 ] = {};
+      exponent_type exponents[ Capacity > 0 ? Capacity : 1 ] = {};
+      for( size_t i = 0; i < mySize; i++ )
+      {
+         coefficients[ i ] = terms[ i ].coef;
+         exponents[ i ] = terms[ i ].expon;
+      }
+
+      PolynomialType polynomial( mySize );
+      polynomial.setPolynomial( coefficients, exponents, static_cast< int >( mySize ) );
+      return polynomial;
+   }
+
+private:
+   std::array< Term< T >, Capacity > terms; // terms[ 0 .. mySize ) by decreasing exponent
+   size_t mySize;
+
+   // Prints "message" and stops the program; in a constant expression the
+   // call makes the evaluation fail to compile instead
+   static void fail( const char *message )
+   {
+      std::cout << message << '\n';
+      std::exit( 1 );
+   }
+
+   // Attaches a new term after the others, which have higher exponents
+   constexpr void attach( T coefficient, exponent_type exponent )
+   {
+      if( coefficient == 0 )
+         return;
+      if( mySize == Capacity )
+         fail( "FixedPolynomial capacity exceeded" );
+
+      terms[ mySize ].coef = coefficient;
+      terms[ mySize ].expon = exponent;
+      mySize++;
+   }
+
+   // Adds transform( t ) for every term t of op2; transform must keep the
+   // order of the exponents
+   template< typename Transform >
+   constexpr void mergeTerms( const FixedPolynomial &op2, Transform transform )
+   {
+      FixedPolynomial sum;
+      size_t i = 0;
+      size_t j = 0;
+      while( i < mySize && j < op2.mySize )
+      {
+         Term< T > term = transform( op2.terms[ j ] );
+         if( terms[ i ].expon > term.expon )
+         {
+            sum.attach( terms[ i ].coef, terms[ i ].expon );
+            i++;
+         }
+         else if( terms[ i ].expon < term.expon )
+         {
+            sum.attach( term.coef, term.expon );
+            j++;
+         }
+         else
+         {
+            sum.attach( terms[ i ].coef + term.coef, term.expon );
+            i++;
+            j++;
+         }
+      }
+
+      for( ; i < mySize; i++ )
+         sum.attach( terms[ i ].coef, terms[ i ].expon );
+      for( ; j < op2.mySize; j++ )
+      {
+         Term< T > term = transform( op2.terms[ j ] );
+         sum.attach( term.coef, term.expon );
+      }
+
+      *this = sum;
+   }
+
+   // Adds term * op2
+   constexpr void addProduct( const Term< T > &term, const FixedPolynomial &op2 )
+   {
+      mergeTerms( op2, [ &term ]( const Term< T > &right )
+      {
+         Term< T > product{};
+         product.coef = term.coef * right.coef;
+         product.expon = term.expon + right.expon;
+         return product;
+      } );
+   }
+
+   // Returns the largest r with r * r <= value, or 0 for negative values
+   static constexpr T integerSquareRoot( T value )
+   {
+      T low = 0;
+      T high = value;
+      while( low < high )
+      {
+         T middle = low + ( high - low + 1 ) / 2;
+         if( middle <= value / middle )
+            low = middle;
+         else
+            high = middle - 1;
+      }
+      return low;
+   }
+
+   static constexpr T power( T x, exponent_type exponent )
+   {
+      T result = 1;
+      while( exponent > 0 )
+      {
+         if( exponent % 2 == 1 )
+            result *= x;
+         exponent /= 2;
+         if( exponent > 0 )
+            x *= x;
+      }
+      return result;
+   }
+}; // end class template FixedPolynomial
+
+#endif // FIXEDPOLYNOMIAL_H
\ No newline at end of file
@@ -0,0 +1,145 @@
+// Format header
+// Allocation-free text output of polynomials with std::to_chars,
+// and a writer that batches many of them into a single ostream::write.
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <charconv>
+#include <cstring>
+#include <ostream>
+#include <system_error>
+#include <type_traits>
+using std::ostream;
+
+#include "ModInt - 1111514 - hw5.h"
+
+template< typename T1, typename T2 >
+class Polynomial;
+
+// Copies "text" into [ first, last ).
+inline std::to_chars_result appendText( char *first, char *last, const char *text )
+{
+   size_t length = strlen( text );
+   if( static_cast< size_t >( last - first ) < length )
+      return { last, std::errc::value_too_large };
+
+   memcpy( first, text, length );
+   return { first + length, std::errc() };
+}
+
+// Writes |value| into [ first, last ); the most negative value is handled too.
+template< typename T >
+std::to_chars_result appendMagnitude( char *first, char *last, const T &value )
+{
+   if( value < 0 )
+      return std::to_chars( first, last, 0 - static_cast< unsigned long long >( value ) );
+   return std::to_chars( first, last, value );
+}
+
+// Modular coefficients are written as their canonical representatives.
+template< unsigned long long P >
+std::to_chars_result appendMagnitude( char *first, char *last, const ModInt< P > &value )
+{
+   return std::to_chars( first, last, value.value() );
+}
+
+// CLASS PolynomialWriter
+// Collects text in a buffer and hands it to the stream in one write() when the
+// buffer fills up, on flush() and on destruction. Nothing is ever flushed
+// line by line, so use it in place of cout << ... << endl loops.
+class PolynomialWriter
+{
+public:
+   explicit PolynomialWriter( ostream &outStream, size_t initialCapacity = 1 << 16 )
+      : output( outStream ),
+        buffer( new char[ initialCapacity > 0 ? initialCapacity : 1 ] ),
+        capacity( initialCapacity > 0 ? initialCapacity : 1 ),
+        mySize( 0 )
+   {
+   }
+
+   PolynomialWriter( const PolynomialWriter & ) = delete;
+   PolynomialWriter& operator=( const PolynomialWriter & ) = delete;
+
+   // Flushes the buffered text and releases the buffer.
+   ~PolynomialWriter()
+   {
+      flush();
+      delete[] buffer;
+   }
+
+   PolynomialWriter& operator<<( const char *text )
+   {
+      append( [ text ]( char *first, char *last ) { return appendText( first, last, text ); } );
+      return *this;
+   }
+
+   PolynomialWriter& operator<<( char c )
+   {
+      append( [ c ]( char *first, char *last ) -> std::to_chars_result
+      {
+         if( first == last )
+            return { last, std::errc::value_too_large };
+         *first = c;
+         return { first + 1, std::errc() };
+      } );
+      return *this;
+   }
+
+   template< typename T, typename = typename std::enable_if< std::is_integral< T >::value >::type >
+   PolynomialWriter& operator<<( T value )
+   {
+      append( [ value ]( char *first, char *last ) { return std::to_chars( first, last, value ); } );
+      return *this;
+   }
+
+   // Writes the polynomial exactly as operator<< for ostream does.
+   template< typename T1, typename T2 >
+   PolynomialWriter& operator<<( const Polynomial< T1, T2 > &a )
+   {
+      append( [ &a ]( char *first, char *last ) { return a.format( first, last ); } );
+      return *this;
+   }
+
+   // Hands all buffered text to the stream.
+   void flush()
+   {
+      if( mySize > 0 )
+         output.write( buffer, static_cast< std::streamsize >( mySize ) );
+      mySize = 0;
+   }
+
+private:
+   ostream &output; // the destination stream
+   char *buffer;    // the buffered text
+   size_t capacity; // the size of buffer
+   size_t mySize;   // the number of buffered characters
+
+   // Lets render( first, last ) write into the free part of the buffer;
+   // on overflow the buffer is flushed, and grown if it was already empty.
+   template< typename Render >
+   void append( Render render )
+   {
+      for( ;; )
+      {
+         std::to_chars_result result = render( buffer + mySize, buffer + capacity );
+         if( result.ec == std::errc() )
+         {
+            mySize = static_cast< size_t >( result.ptr - buffer );
+            return;
+         }
+
+         if( mySize > 0 )
+            flush();
+         else
+         {
+            delete[] buffer;
+            capacity *= 2;
+            buffer = new char[ capacity ];
+         }
+      }
+   }
+}; // end class PolynomialWriter
+
+#endif // FORMAT_H
\ No newline at end of file
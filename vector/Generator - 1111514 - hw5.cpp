@@ -0,0 +1,266 @@
+// Generator of polynomial corpora
+// Writes random perfect squares, whose square roots compSquareRoot must find,
+// in the .dat layout of "Polynomials - *.dat" (optionally with longer records)
+// or in the binary corpus format.
+//
+// usage: Generator fileName [options]
+//    --bytes 2|4|8       coefficient and exponent size: short, long or long long (8)
+//    --count N           the number of polynomials (200)
+//    --degree D          the degree of every square root (10)
+//    --spread S          root exponents lie in [ D - S, D ] (D)
+//    --density P         the fraction of those exponents present in a root (0.5)
+//    --coef C            the largest root coefficient magnitude (100)
+//    --seed N            the random seed (1111514)
+//    --format dat|binary the output layout (dat)
+//    --record-terms N    terms per .dat record (20); squares never exceed it.
+//                        Benchmark times such a corpus with --dat and --record-terms
+//
+// Root coefficients are clamped so that no coefficient of a square, or of any
+// intermediate step of compSquareRoot, can overflow the target type. Records
+// are written as they are generated, so corpora of any size take little memory.
+
+#include <iostream>
+using std::cout;
+using std::endl;
+using std::ostream;
+
+#include <fstream>
+using std::ofstream;
+using std::ios;
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <unordered_set>
+
+#include "Polynomial - 1111514 - hw5-2.h"
+#include "BinaryCorpus - 1111514 - hw5.h"
+
+// Settings from the command line
+struct Options
+{
+   const char *fileName = nullptr;
+   int bytes = 8;
+   unsigned long long count = 200;
+   long long degree = 10;
+   long long spread = -1;     // -1 means degree
+   double density = 0.5;
+   long long coef = 100;
+   unsigned long long seed = 1111514;
+   bool binary = false;
+   size_t recordTerms = 20;
+};
+
+using Wide = Polynomial< vector< Term< long long > >, long long >;
+
+void usage();
+
+template< typename T >
+void generate( const Options &options );
+
+// Returns a random root: k distinct exponents from [ degree - spread, degree ],
+// always including degree, with nonzero coefficients in [ -coefBound, coefBound ]
+// and a positive leading coefficient.
+Wide randomRoot( std::mt19937_64 &engine, long long degree, long long spread, size_t k, long long coefBound );
+
+int main( int argc, char *argv[] )
+{
+   Options options;
+   if( argc < 2 )
+      usage();
+   options.fileName = argv[ 1 ];
+
+   for( int i = 2; i < argc; i += 2 )
+   {
+      if( i + 1 >= argc )
+         usage();
+
+      const char *value = argv[ i + 1 ];
+      if( strcmp( argv[ i ], "--bytes" ) == 0 )
+         options.bytes = atoi( value );
+      else if( strcmp( argv[ i ], "--count" ) == 0 )
+         options.count = strtoull( value, nullptr, 10 );
+      else if( strcmp( argv[ i ], "--degree" ) == 0 )
+         options.degree = atoll( value );
+      else if( strcmp( argv[ i ], "--spread" ) == 0 )
+         options.spread = atoll( value );
+      else if( strcmp( argv[ i ], "--density" ) == 0 )
+         options.density = atof( value );
+      else if( strcmp( argv[ i ], "--coef" ) == 0 )
+         options.coef = atoll( value );
+      else if( strcmp( argv[ i ], "--seed" ) == 0 )
+         options.seed = strtoull( value, nullptr, 10 );
+      else if( strcmp( argv[ i ], "--format" ) == 0 && strcmp( value, "dat" ) == 0 )
+         options.binary = false;
+      else if( strcmp( argv[ i ], "--format" ) == 0 && strcmp( value, "binary" ) == 0 )
+         options.binary = true;
+      else if( strcmp( argv[ i ], "--record-terms" ) == 0 )
+         options.recordTerms = static_cast< size_t >( atoll( value ) );
+      else
+         usage();
+   }
+
+   if( options.spread < 0 || options.spread > options.degree )
+      options.spread = options.degree;
+
+   if( options.degree < 0 || options.coef < 1 || options.density <= 0 || options.density > 1 ||
+       options.recordTerms < 1 )
+      usage();
+
+   if( options.bytes == 2 )
+      generate< int16_t >( options );
+   else if( options.bytes == 4 )
+      generate< int32_t >( options );
+   else if( options.bytes == 8 )
+      generate< int64_t >( options );
+   else
+      usage();
+}
+
+void usage()
+{
+   cout << "usage: Generator fileName [--bytes 2|4|8] [--count N] [--degree D] [--spread S]\n"
+        << "                 [--density P] [--coef C] [--seed N] [--format dat|binary]\n"
+        << "                 [--record-terms N]" << endl;
+   exit( 1 );
+}
+
+template< typename T >
+void generate( const Options &options )
+{
+   // exponents of squares are stored in T as well
+   long long largest = std::numeric_limits< T >::max();
+   if( options.degree > largest / 2 )
+   {
+      cout << "Degree " << options.degree << " does not fit: squares need exponents up to "
+           << 2 * options.degree << endl;
+      exit( 1 );
+   }
+
+   size_t k = static_cast< size_t >( options.density * ( options.spread + 1 ) + 0.5 );
+   if( k < 1 )
+      k = 1;
+
+   // every coefficient of a square, and every partial sum compSquareRoot forms,
+   // is a sum of at most 2k products of two root coefficients
+   long long coefBound = static_cast< long long >( sqrt( static_cast< double >( largest ) / ( 2.0 * k ) ) );
+   if( coefBound > options.coef )
+      coefBound = options.coef;
+   if( coefBound < 1 )
+   {
+      cout << "Roots of " << k << " terms do not fit in " << sizeof( T ) << "-byte coefficients" << endl;
+      exit( 1 );
+   }
+
+   ofstream outFile( options.fileName, ios::out | ios::binary );
+   if( !outFile )
+   {
+      cout << "File could not be opened" << endl;
+      exit( 1 );
+   }
+
+   std::mt19937_64 engine( options.seed );
+   BinaryCorpusWriter< T > *binary = options.binary ? new BinaryCorpusWriter< T >( outFile ) : nullptr;
+   T *record = new T[ 2 * options.recordTerms ];
+   unsigned long long totalTerms = 0;
+
+   for( unsigned long long i = 0; i < options.count; i++ )
+   {
+      Wide square;
+      for( int attempt = 0;; attempt++ )
+      {
+         square = randomRoot( engine, options.degree, options.spread, k, coefBound ).square();
+         if( options.binary || square.size() <= options.recordTerms )
+            break;
+
+         // collisions may still bring an oversized square within a record
+         if( attempt == 1000 )
+         {
+            cout << "Squares of " << k << "-term roots do not fit in " << options.recordTerms
+                 << "-term records; use fewer terms or --record-terms" << endl;
+            exit( 1 );
+         }
+      }
+
+      size_t numTerms = square.size();
+      totalTerms += numTerms;
+      if( binary != nullptr )
+      {
+         T *coefficients = new T[ numTerms ];
+         T *exponents = new T[ numTerms ];
+         for( size_t j = 0; j < numTerms; j++ )
+         {
+            coefficients[ j ] = static_cast< T >( square.term( j ).coef );
+            exponents[ j ] = static_cast< T >( square.term( j ).expon );
+         }
+         bool written = binary->write( coefficients, exponents, numTerms );
+         delete[] coefficients;
+         delete[] exponents;
+         if( !written )
+         {
+            cout << "Record " << i << " has too many terms for a binary corpus" << endl;
+            exit( 1 );
+         }
+      }
+      else
+      {
+         // coefficients, then exponents, each zero-padded to recordTerms
+         std::fill( record, record + 2 * options.recordTerms, T() );
+         for( size_t j = 0; j < numTerms; j++ )
+         {
+            record[ j ] = static_cast< T >( square.term( j ).coef );
+            record[ options.recordTerms + j ] = static_cast< T >( square.term( j ).expon );
+         }
+         outFile.write( reinterpret_cast< const char * >( record ), 2 * options.recordTerms * sizeof( T ) );
+      }
+   }
+
+   if( binary != nullptr )
+   {
+      binary->finish();
+      delete binary;
+   }
+   delete[] record;
+
+   if( !outFile )
+   {
+      cout << "Writing " << options.fileName << " failed" << endl;
+      exit( 1 );
+   }
+
+   cout << "Wrote " << options.count << " squares of " << k << "-term roots, " << totalTerms
+        << " terms, with coefficients of " << sizeof( T ) << " bytes to " << options.fileName << endl;
+}
+
+Wide randomRoot( std::mt19937_64 &engine, long long degree, long long spread, size_t k, long long coefBound )
+{
+   // Floyd's sampling of k - 1 distinct exponents below degree
+   std::unordered_set< long long > chosen;
+   chosen.insert( degree );
+   long long lowest = degree - spread;
+   for( long long j = spread - static_cast< long long >( k ) + 1; j < spread; j++ )
+   {
+      long long expon = lowest + std::uniform_int_distribution< long long >( 0, j )( engine );
+      if( !chosen.insert( expon ).second )
+         chosen.insert( lowest + j );
+   }
+
+   long long *exponents = new long long[ chosen.size() ];
+   std::copy( chosen.begin(), chosen.end(), exponents );
+   std::sort( exponents, exponents + chosen.size(), []( long long x, long long y ) { return x > y; } );
+
+   std::uniform_int_distribution< long long > coefs( 1, coefBound );
+   long long *coefficients = new long long[ chosen.size() ];
+   for( size_t j = 0; j < chosen.size(); j++ )
+      coefficients[ j ] = j > 0 && engine() % 2 == 1 ? -coefs( engine ) : coefs( engine );
+
+   Wide root( chosen.size() );
+   root.setPolynomial( coefficients, exponents, static_cast< int >( chosen.size() ) );
+
+   delete[] coefficients;
+   delete[] exponents;
+   return root;
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+// MappedFile header
+// Read-only memory mapping of a whole file (mmap, or a file mapping on Windows).
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+
+#if defined( _WIN32 )
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// CLASS MappedFile
+class MappedFile
+{
+public:
+   // Constructs an object that maps no file.
+   MappedFile()
+      : myData( nullptr ),
+        mySize( 0 ),
+        mapped( false )
+   {
+   }
+
+   // Maps the file named "fileName"; check isOpen() afterwards.
+   explicit MappedFile( const char *fileName )
+      : MappedFile()
+   {
+      open( fileName );
+   }
+
+   MappedFile( const MappedFile & ) = delete;
+   MappedFile& operator=( const MappedFile & ) = delete;
+
+   // Unmaps the file.
+   ~MappedFile()
+   {
+      close();
+   }
+
+   // Maps the file named "fileName", read-only, in place of any previous one.
+   // Returns false if the file cannot be opened or mapped.
+   // Sequential access is advised to the operating system where supported.
+   bool open( const char *fileName )
+   {
+      close();
+
+#if defined( _WIN32 )
+      HANDLE file = CreateFileA( fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+      if( file == INVALID_HANDLE_VALUE )
+         return false;
+
+      LARGE_INTEGER fileSize;
+      if( !GetFileSizeEx( file, &fileSize ) )
+      {
+         CloseHandle( file );
+         return false;
+      }
+
+      mySize = static_cast< size_t >( fileSize.QuadPart );
+      if( mySize > 0 )
+      {
+         HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+         if( mapping != nullptr )
+         {
+            myData = static_cast< const unsigned char * >( MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) );
+            CloseHandle( mapping );
+         }
+      }
+      CloseHandle( file );
+#else
+      int file = ::open( fileName, O_RDONLY );
+      if( file < 0 )
+         return false;
+
+      struct stat status;
+      if( fstat( file, &status ) != 0 )
+      {
+         ::close( file );
+         return false;
+      }
+
+      mySize = static_cast< size_t >( status.st_size );
+      if( mySize > 0 )
+      {
+         void *address = mmap( nullptr, mySize, PROT_READ, MAP_PRIVATE, file, 0 );
+         if( address != MAP_FAILED )
+         {
+            myData = static_cast< const unsigned char * >( address );
+            madvise( address, mySize, MADV_SEQUENTIAL );
+         }
+      }
+      ::close( file );
+#endif
+
+      if( mySize > 0 && myData == nullptr )
+      {
+         mySize = 0;
+         return false;
+      }
+
+      mapped = true;
+      return true;
+   }
+
+   // Unmaps the current file, if any.
+   void close()
+   {
+      if( myData != nullptr )
+      {
+#if defined( _WIN32 )
+         UnmapViewOfFile( myData );
+#else
+         munmap( const_cast< unsigned char * >( myData ), mySize );
+#endif
+      }
+
+      myData = nullptr;
+      mySize = 0;
+      mapped = false;
+   }
+
+   // Returns true if a file is mapped (an empty file counts).
+   bool isOpen() const
+   {
+      return mapped;
+   }
+
+   // Returns the first byte of the file, or nullptr for an empty file.
+   const unsigned char* data() const
+   {
+      return myData;
+   }
+
+   // Returns the size of the file in bytes.
+   size_t size() const
+   {
+      return mySize;
+   }
+
+private:
+   const unsigned char *myData; // the mapped bytes
+   size_t mySize;               // the number of mapped bytes
+   bool mapped;                 // true if open() succeeded
+}; // end class MappedFile
+
+#endif // MAPPEDFILE_H
\ No newline at end of file
@@ -0,0 +1,91 @@
+// Merge header
+// Merges two arrays of terms sorted by decreasing exponent into their sum,
+// the kernel of Polynomial's += and -= and of every fold of rows into a
+// product. Term by term the merge is the textbook one. When one side has
+// supplied several terms in a row, the merge checks whether its next
+// MergeBlock terms all come before the other side's next term, as they do
+// when a short polynomial is added to a long one, and copies such a run
+// whole without comparing each of its terms.
+
+#ifndef MERGE_H
+#define MERGE_H
+
+#include <cstddef>
+
+template< typename T >
+struct Term;
+
+// The length of the runs that mergeTermArrays copies whole
+const size_t MergeBlock = 8;
+
+// The number of terms one side must supply in a row before a run is tried
+const size_t MergeStreak = 4;
+
+// Writes the sum of a[ 0 .. n ) and transform( b[ j ] ), j < m, to "sum",
+// which must have room for n + m terms, and returns the number of terms
+// written. Both arrays are sorted by decreasing exponent, a has no zero
+// coefficients, and transform must keep the order of the exponents; terms
+// whose coefficients sum to zero are left out of sum.
+template< typename T, typename Transform >
+size_t mergeTermArrays( const Term< T > *a, size_t n, const Term< T > *b, size_t m,
+                        Term< T > *sum, Transform transform )
+{
+   size_t i = 0;
+   size_t j = 0;
+   size_t k = 0;
+   size_t streakA = 0; // the number of terms a has supplied in a row
+   size_t streakB = 0;
+   while( i < n && j < m )
+   {
+      Term< T > right = transform( b[ j ] );
+      if( a[ i ].expon > right.expon )
+      {
+         streakB = 0;
+         if( ++streakA >= MergeStreak && n - i >= MergeBlock && a[ i + MergeBlock - 1 ].expon > right.expon )
+         {
+            for( size_t r = 0; r < MergeBlock; r++ )
+               sum[ k + r ] = a[ i + r ];
+            i += MergeBlock;
+            k += MergeBlock;
+         }
+         else
+            sum[ k++ ] = a[ i++ ];
+      }
+      else if( a[ i ].expon < right.expon )
+      {
+         streakA = 0;
+         if( ++streakB >= MergeStreak && m - j >= MergeBlock && transform( b[ j + MergeBlock - 1 ] ).expon > a[ i ].expon )
+         {
+            sum[ k ] = right;
+            for( size_t r = 1; r < MergeBlock; r++ )
+               sum[ k + r ] = transform( b[ j + r ] );
+            j += MergeBlock;
+            k += MergeBlock;
+         }
+         else
+         {
+            sum[ k++ ] = right;
+            j++;
+         }
+      }
+      else
+      {
+         streakA = 0;
+         streakB = 0;
+         right.coef += a[ i ].coef;
+         if( right.coef != T() )
+            sum[ k++ ] = right;
+         i++;
+         j++;
+      }
+   }
+
+   for( ; i < n; i++ )
+      sum[ k++ ] = a[ i ];
+   for( ; j < m; j++ )
+      sum[ k++ ] = transform( b[ j ] );
+
+   return k;
+}
+
+#endif // MERGE_H
\ No newline at end of file
@@ -0,0 +1,261 @@
+// ModInt header
+// Integers modulo a compile-time prime P < 2^62, kept in Montgomery form
+// (R = 2^64) so that multiplication needs no division.
+
+#ifndef MODINT_H
+#define MODINT_H
+
+#include <iostream>
+using std::ostream;
+
+#include <cstdlib>
+
+#if defined( _MSC_VER ) && defined( _M_X64 )
+#include <intrin.h>
+#endif
+
+// Returns the low 64 bits of a * b and stores the high 64 bits in "high".
+inline unsigned long long mulWide( unsigned long long a, unsigned long long b,
+                                   unsigned long long &high )
+{
+#if defined( __SIZEOF_INT128__ )
+   unsigned __int128 product = static_cast< unsigned __int128 >( a ) * b;
+   high = static_cast< unsigned long long >( product >> 64 );
+   return static_cast< unsigned long long >( product );
+#elif defined( _MSC_VER ) && defined( _M_X64 )
+   return _umul128( a, b, &high );
+#else
+   unsigned long long aLow = a & 0xFFFFFFFFULL, aHigh = a >> 32;
+   unsigned long long bLow = b & 0xFFFFFFFFULL, bHigh = b >> 32;
+   unsigned long long lowLow = aLow * bLow;
+   unsigned long long highLow = aHigh * bLow;
+   unsigned long long lowHigh = aLow * bHigh;
+   unsigned long long middle = ( lowLow >> 32 ) + ( highLow & 0xFFFFFFFFULL ) + lowHigh;
+   high = aHigh * bHigh + ( highLow >> 32 ) + ( middle >> 32 );
+   return ( middle << 32 ) | ( lowLow & 0xFFFFFFFFULL );
+#endif
+}
+
+// CLASS TEMPLATE ModInt
+// The default modulus 2^62 - 57 is the largest prime below 2^62.
+template< unsigned long long P = 4611686018427387847ULL >
+class ModInt
+{
+   static_assert( P % 2 == 1 && P < ( 1ULL << 62 ), "ModInt needs an odd modulus below 2^62" );
+
+public:
+   static constexpr unsigned long long modulus = P;
+
+   // Constructs the zero residue.
+   ModInt()
+      : myVal( 0 )
+   {
+   }
+
+   // Constructs the residue of "value" modulo P; negative values are allowed.
+   ModInt( long long value )
+   {
+      long long r = value % static_cast< long long >( P );
+      r += static_cast< long long >( P ) & -static_cast< long long >( r < 0 );
+      myVal = reduce( static_cast< unsigned long long >( r ), rSquared );
+   }
+
+   // Returns the canonical representative in [0, P).
+   unsigned long long value() const
+   {
+      return reduce( myVal, 1 );
+   }
+
+   ModInt& operator+=( const ModInt &right )
+   {
+      myVal = normalize( myVal + right.myVal - P );
+      return *this;
+   }
+
+   ModInt& operator-=( const ModInt &right )
+   {
+      myVal = normalize( myVal - right.myVal );
+      return *this;
+   }
+
+   ModInt& operator*=( const ModInt &right )
+   {
+      myVal = reduce( myVal, right.myVal );
+      return *this;
+   }
+
+   // Division multiplies by the inverse, so "right" must be nonzero.
+   ModInt& operator/=( const ModInt &right )
+   {
+      return *this *= right.inverse();
+   }
+
+   ModInt operator-() const
+   {
+      ModInt result;
+      result.myVal = normalize( 0 - myVal );
+      return result;
+   }
+
+   // Returns this^exponent by binary exponentiation.
+   ModInt pow( unsigned long long exponent ) const
+   {
+      ModInt result = 1;
+      ModInt base = *this;
+      for( ; exponent != 0; exponent >>= 1 )
+      {
+         if( exponent & 1 )
+            result *= base;
+         base *= base;
+      }
+
+      return result;
+   }
+
+   // Returns the multiplicative inverse (Fermat); the inverse of 0 is 0.
+   ModInt inverse() const
+   {
+      return pow( P - 2 );
+   }
+
+   friend ModInt operator+( ModInt left, const ModInt &right )
+   {
+      return left += right;
+   }
+
+   friend ModInt operator-( ModInt left, const ModInt &right )
+   {
+      return left -= right;
+   }
+
+   friend ModInt operator*( ModInt left, const ModInt &right )
+   {
+      return left *= right;
+   }
+
+   friend ModInt operator/( ModInt left, const ModInt &right )
+   {
+      return left /= right;
+   }
+
+   // Montgomery form is a bijection, so equality compares it directly.
+   friend bool operator==( const ModInt &left, const ModInt &right )
+   {
+      return left.myVal == right.myVal;
+   }
+
+   friend bool operator!=( const ModInt &left, const ModInt &right )
+   {
+      return left.myVal != right.myVal;
+   }
+
+   // Ordering uses canonical representatives, so no residue is negative.
+   friend bool operator<( const ModInt &left, const ModInt &right )
+   {
+      return left.value() < right.value();
+   }
+
+   friend bool operator>( const ModInt &left, const ModInt &right )
+   {
+      return right < left;
+   }
+
+   // Returns the smaller square root of a, so that squares of small positive
+   // integers give the integer back; exits if a is not a quadratic residue.
+   friend ModInt sqrt( const ModInt &a )
+   {
+      if( a.myVal == 0 )
+         return a;
+
+      if( a.pow( ( P - 1 ) / 2 ) != 1 )
+      {
+         std::cout << "ModInt square root of a non-residue\n";
+         exit( 1 );
+      }
+
+      // Tonelli-Shanks; P - 1 = q * 2^s with q odd
+      unsigned long long q = P - 1;
+      int s = 0;
+      for( ; q % 2 == 0; q /= 2 )
+         s++;
+
+      ModInt z = 2;
+      while( z.pow( ( P - 1 ) / 2 ) == 1 )
+         z += 1;
+
+      ModInt c = z.pow( q );
+      ModInt root = a.pow( ( q + 1 ) / 2 );
+      ModInt t = a.pow( q );
+      while( t != 1 )
+      {
+         int i = 0;
+         for( ModInt u = t; u != 1; u *= u )
+            i++;
+
+         ModInt b = c;
+         for( int j = 0; j < s - i - 1; j++ )
+            b *= b;
+
+         root *= b;
+         c = b * b;
+         t *= c;
+         s = i;
+      }
+
+      ModInt other = -root;
+      return other.value() < root.value() ? other : root;
+   }
+
+   friend ostream& operator<<( ostream &output, const ModInt &a )
+   {
+      return output << a.value();
+   }
+
+private:
+   unsigned long long myVal; // Montgomery form, value * 2^64 mod P, in [0, P)
+
+   // -P^-1 mod 2^64 by Newton iteration; each step doubles the correct bits
+   static constexpr unsigned long long compNegInverse()
+   {
+      unsigned long long inverse = P;
+      for( int i = 0; i < 6; i++ )
+         inverse *= 2 - P * inverse;
+      return 0 - inverse;
+   }
+
+   // 2^128 mod P by repeated doubling, used to enter Montgomery form
+   static constexpr unsigned long long compRSquared()
+   {
+      unsigned long long r = 1;
+      for( int i = 0; i < 128; i++ )
+      {
+         r <<= 1;
+         if( r >= P )
+            r -= P;
+      }
+      return r;
+   }
+
+   static constexpr unsigned long long negInverse = compNegInverse();
+   static constexpr unsigned long long rSquared = compRSquared();
+
+   // Maps x in [-P, P) (as two's complement) to [0, P) without branching.
+   static unsigned long long normalize( unsigned long long x )
+   {
+      return x + ( P & ( 0 - ( x >> 63 ) ) );
+   }
+
+   // Montgomery reduction of a * b, returning a * b / 2^64 mod P in [0, P).
+   // With a, b < P < 2^62 the unreduced result stays below 2P.
+   static unsigned long long reduce( unsigned long long a, unsigned long long b )
+   {
+      unsigned long long high;
+      unsigned long long low = mulWide( a, b, high );
+      unsigned long long mHigh;
+      mulWide( low * negInverse, P, mHigh );
+      unsigned long long result = high + mHigh + ( low != 0 );
+      return normalize( result - P );
+   }
+}; // end class template ModInt
+
+#endif // MODINT_H
\ No newline at end of file
@@ -0,0 +1,465 @@
+// Multiply header
+// Multiplication kernels over arrays of terms sorted by decreasing exponent.
+
+#ifndef MULTIPLY_H
+#define MULTIPLY_H
+
+#include <cstddef>
+
+#include "ScratchArena - 1111514 - hw5.h"
+#include "ThreadPool - 1111514 - hw5.h"
+
+#if defined( _MSC_VER )
+#include <xmmintrin.h>
+#endif
+
+template< typename T >
+struct Term;
+
+// CLASS TEMPLATE TermAccumulator
+// Open-addressing hash table (linear probing) from exponent to coefficient.
+// Exponents are stored as offsets from the smallest possible exponent plus 1,
+// so that a key of 0 marks an empty slot.
+// The table and the buffers of extract() come from "arena" if one is given,
+// and from the heap otherwise; an accumulator that is filled on one thread
+// and extracted on another must use the heap.
+template< typename T >
+class TermAccumulator
+{
+public:
+   using exponent_type = typename Term< T >::exponent_type;
+
+   // Constructs a table for at most "expected" distinct exponents,
+   // all of which lie in [lowest, highest].
+   TermAccumulator( size_t expected, long long lowest, long long highest, ScratchArena *arena = nullptr )
+      : myLowest( lowest ),
+        mySize( 0 ),
+        largest( 0 ),
+        myArena( arena )
+   {
+      unsigned long long span = static_cast< unsigned long long >( highest - lowest ) + 1;
+      if( expected > span )
+         expected = static_cast< size_t >( span );
+
+      // keep the load factor at most 3/4
+      size_t capacity = 16;
+      shift = 60;
+      while( capacity - capacity / 4 < expected )
+      {
+         capacity *= 2;
+         shift--;
+      }
+
+      mask = capacity - 1;
+      slots = allocate< Slot >( capacity );
+   }
+
+   TermAccumulator( const TermAccumulator & ) = delete;
+   TermAccumulator& operator=( const TermAccumulator & ) = delete;
+
+   ~TermAccumulator()
+   {
+      release( slots );
+   }
+
+   // Adds coef * x^expon to the table.
+   void add( long long expon, const T &coef )
+   {
+      unsigned long long key = static_cast< unsigned long long >( expon - myLowest ) + 1;
+      size_t i = slotOf( key );
+      while( slots[ i ].key != 0 && slots[ i ].key != key )
+         i = ( i + 1 ) & mask;
+
+      if( slots[ i ].key == 0 )
+      {
+         slots[ i ].key = key;
+         slots[ i ].coef = coef;
+         mySize++;
+      }
+      else
+         slots[ i ].coef += coef;
+   }
+
+   // Adds a[ i ].coef * b[ j ].coef * x^( a[ i ].expon + b[ j ].expon ) to the
+   // table for every i in [ 0, n ) and j in [ 0, m ).
+   // Slots are prefetched a few products ahead, since on large tables nearly
+   // every probe misses the cache.
+   void addProducts( const Term< T > *a, size_t n, const Term< T > *b, size_t m )
+   {
+      const size_t distance = 8;
+      for( size_t i = 0; i < n; i++ )
+      {
+         long long expon = a[ i ].expon;
+         for( size_t j = 0; j < m; j++ )
+         {
+            if( j + distance < m )
+               prefetch( expon + b[ j + distance ].expon );
+            add( expon + b[ j ].expon, a[ i ].coef * b[ j ].coef );
+         }
+      }
+   }
+
+   // Adds the products a[ i ] * a[ j ] for j in [ first, last ) with j >= i,
+   // doubling those with j > i, so that row i of a square needs only the
+   // pairs on and above the diagonal.
+   void addSquareRow( const Term< T > *a, size_t i, size_t first, size_t last )
+   {
+      if( first <= i )
+      {
+         if( i < last )
+            add( 2 * static_cast< long long >( a[ i ].expon ), a[ i ].coef * a[ i ].coef );
+         first = i + 1;
+      }
+
+      const size_t distance = 8;
+      long long expon = a[ i ].expon;
+      for( size_t j = first; j < last; j++ )
+      {
+         if( j + distance < last )
+            prefetch( expon + a[ j + distance ].expon );
+         T product = a[ i ].coef * a[ j ].coef;
+         add( expon + a[ j ].expon, product + product );
+      }
+   }
+
+   // Drops the entries whose coefficients cancelled to zero and returns the
+   // number of terms left. No terms may be added afterwards.
+   size_t compact()
+   {
+      size_t count = 0;
+      largest = 0;
+      for( size_t i = 0; i <= mask; i++ )
+         if( slots[ i ].key != 0 && slots[ i ].coef != T() )
+         {
+            if( slots[ i ].key > largest )
+               largest = slots[ i ].key;
+            slots[ count++ ] = slots[ i ];
+         }
+
+      mySize = count;
+      return count;
+   }
+
+   // Writes the terms left by compact() into out[ 0 .. size() ) by
+   // decreasing exponent.
+   void extract( Term< T > *out )
+   {
+      size_t count = mySize;
+
+      // LSD radix sort by increasing key, 11 bits per pass;
+      // the histograms of all passes are gathered in one sweep
+      const int radixBits = 11;
+      const size_t radix = size_t( 1 ) << radixBits;
+      int passes = 0;
+      while( passes * radixBits < 64 && ( largest >> ( passes * radixBits ) ) != 0 )
+         passes++;
+
+      size_t *counts = allocate< size_t >( passes * radix );
+      for( size_t i = 0; i < count; i++ )
+         for( int pass = 0; pass < passes; pass++ )
+            counts[ pass * radix + ( ( slots[ i ].key >> ( pass * radixBits ) ) & ( radix - 1 ) ) ]++;
+
+      Slot *source = slots;
+      Slot *target = allocate< Slot >( count > 0 ? count : 1 );
+      Slot *buffer = target;
+      for( int pass = 0; pass < passes; pass++ )
+      {
+         size_t *digitCounts = counts + pass * radix;
+         size_t digit = ( largest >> ( pass * radixBits ) ) & ( radix - 1 );
+         if( digitCounts[ digit ] == count )
+            continue; // every key has the same digit
+
+         // turn the counts into starting positions
+         size_t position = 0;
+         for( size_t d = 0; d < radix; d++ )
+         {
+            size_t digitCount = digitCounts[ d ];
+            digitCounts[ d ] = position;
+            position += digitCount;
+         }
+
+         for( size_t i = 0; i < count; i++ )
+            target[ digitCounts[ ( source[ i ].key >> ( pass * radixBits ) ) & ( radix - 1 ) ]++ ] = source[ i ];
+
+         Slot *tmp = source;
+         source = target;
+         target = tmp;
+      }
+
+      for( size_t i = 0; i < count; i++ )
+      {
+         out[ i ].coef = source[ count - 1 - i ].coef;
+         out[ i ].expon = static_cast< exponent_type >( myLowest + static_cast< long long >( source[ count - 1 - i ].key - 1 ) );
+      }
+
+      release( counts );
+      release( buffer );
+   }
+
+   // Returns the number of distinct exponents added so far,
+   // or the number of terms left after compact().
+   size_t size() const
+   {
+      return mySize;
+   }
+
+private:
+   // Returns "count" value-initialized objects from the arena or the heap.
+   template< typename U >
+   U* allocate( size_t count )
+   {
+      if( myArena != nullptr )
+         return myArena->allocate< U >( count );
+      return new U[ count ]();
+   }
+
+   // Frees what allocate() took from the heap; arena memory is freed with
+   // the arena's scope.
+   template< typename U >
+   void release( U *p )
+   {
+      if( myArena == nullptr )
+         delete[] p;
+   }
+
+   // Returns the home slot of "key" (Fibonacci hashing).
+   size_t slotOf( unsigned long long key ) const
+   {
+      return static_cast< size_t >( ( key * 0x9E3779B97F4A7C15ULL ) >> shift );
+   }
+
+   // Hints the processor to load the home slot of "expon".
+   void prefetch( long long expon ) const
+   {
+      const Slot *slot = slots + slotOf( static_cast< unsigned long long >( expon - myLowest ) + 1 );
+#if defined( _MSC_VER )
+      _mm_prefetch( reinterpret_cast< const char * >( slot ), _MM_HINT_T0 );
+#else
+      __builtin_prefetch( slot );
+#endif
+   }
+
+   struct Slot
+   {
+      unsigned long long key; // exponent - myLowest + 1, or 0 if empty
+      T coef;
+   };
+
+   Slot *slots;         // the table
+   size_t mask;         // capacity - 1, where capacity is a power of 2
+   int shift;           // 64 - log2( capacity ), for Fibonacci hashing
+   long long myLowest;  // the smallest exponent that can be added
+   size_t mySize;       // the number of occupied slots
+   unsigned long long largest; // the largest key left by compact()
+   ScratchArena *myArena;      // where the buffers come from, or nullptr for the heap
+}; // end class template TermAccumulator
+
+// Returns the number of pairs ( i, j ) with a[ i ].expon + b[ j ].expon >= bound.
+template< typename T >
+size_t countProductsFrom( const Term< T > *a, size_t n, const Term< T > *b, size_t m, long long bound )
+{
+   // as a[ i ].expon decreases, fewer leading terms of b reach the bound
+   size_t count = 0;
+   size_t j = m;
+   for( size_t i = 0; i < n; i++ )
+   {
+      while( j > 0 && static_cast< long long >( a[ i ].expon ) + b[ j - 1 ].expon < bound )
+         j--;
+      count += j;
+   }
+
+   return count;
+}
+
+// Multiplies a[ 0 .. n ) by b[ 0 .. m ) on the threads of "pool"; if
+// "symmetric", b is a and only the pairs on and above the diagonal are formed.
+// The output exponent range is cut into one band per thread holding about
+// the same number of term products, so every thread accumulates its own
+// disjoint band of output terms and no synchronization is needed.
+// allocate( count ) must return room for the count terms of the product,
+// which are written by decreasing exponent, band after band.
+template< typename T, typename Allocate >
+void parallelProducts( const Term< T > *a, size_t n, const Term< T > *b, size_t m, bool symmetric,
+                       ThreadPool &pool, Allocate allocate )
+{
+   if( n == 0 || m == 0 )
+   {
+      allocate( 0 );
+      return;
+   }
+
+   long long highest = static_cast< long long >( a[ 0 ].expon ) + b[ 0 ].expon;
+   long long lowest = static_cast< long long >( a[ n - 1 ].expon ) + b[ m - 1 ].expon;
+   size_t total = n * m;
+
+   // bounds[ k + 1 ] <= exponents of band k < bounds[ k ]
+   size_t numBands = pool.size();
+   long long *bounds = new long long[ numBands + 1 ];
+   bounds[ 0 ] = highest + 1;
+   bounds[ numBands ] = lowest;
+   for( size_t k = 1; k < numBands; k++ )
+   {
+      // the smallest bound leaving at most k / numBands of the products above
+      size_t target = total / numBands * k;
+      long long low = lowest;
+      long long high = bounds[ k - 1 ];
+      while( low < high )
+      {
+         long long middle = low + ( high - low ) / 2;
+         if( countProductsFrom( a, n, b, m, middle ) <= target )
+            high = middle;
+         else
+            low = middle + 1;
+      }
+      bounds[ k ] = low;
+   }
+
+   TermAccumulator< T > **bands = new TermAccumulator< T > *[ numBands ]();
+   size_t *offsets = new size_t[ numBands + 1 ]();
+
+   pool.run( numBands, [ & ]( size_t k )
+   {
+      if( bounds[ k + 1 ] >= bounds[ k ] )
+         return; // empty band
+
+      size_t expected = countProductsFrom( a, n, b, m, bounds[ k + 1 ] ) -
+                        countProductsFrom( a, n, b, m, bounds[ k ] );
+      bands[ k ] = new TermAccumulator< T >( expected, bounds[ k + 1 ], bounds[ k ] - 1 );
+
+      // row i of the band is b[ first .. last ); both ends only move left
+      size_t first = m;
+      size_t last = m;
+      for( size_t i = 0; i < n; i++ )
+      {
+         long long expon = a[ i ].expon;
+         while( first > 0 && expon + b[ first - 1 ].expon < bounds[ k ] )
+            first--;
+         while( last > 0 && expon + b[ last - 1 ].expon < bounds[ k + 1 ] )
+            last--;
+         if( symmetric )
+            bands[ k ]->addSquareRow( a, i, first, last );
+         else
+            bands[ k ]->addProducts( a + i, 1, b + first, last - first );
+      }
+
+      offsets[ k + 1 ] = bands[ k ]->compact();
+   } );
+
+   for( size_t k = 0; k < numBands; k++ )
+      offsets[ k + 1 ] += offsets[ k ];
+
+   Term< T > *out = allocate( offsets[ numBands ] );
+
+   pool.run( numBands, [ & ]( size_t k )
+   {
+      if( bands[ k ] != nullptr )
+      {
+         bands[ k ]->extract( out + offsets[ k ] );
+         delete bands[ k ];
+      }
+   } );
+
+   delete[] offsets;
+   delete[] bands;
+   delete[] bounds;
+}
+
+// Multiplies a[ 0 .. n ) by b[ 0 .. m ) on the threads of "pool";
+// see parallelProducts.
+template< typename T, typename Allocate >
+void parallelMultiply( const Term< T > *a, size_t n, const Term< T > *b, size_t m,
+                       ThreadPool &pool, Allocate allocate )
+{
+   parallelProducts( a, n, b, m, false, pool, allocate );
+}
+
+// Squares a[ 0 .. n ) on the threads of "pool"; see parallelProducts.
+template< typename T, typename Allocate >
+void parallelSquare( const Term< T > *a, size_t n, ThreadPool &pool, Allocate allocate )
+{
+   parallelProducts( a, n, a, n, true, pool, allocate );
+}
+
+// Returns the number of exponents from a[ n - 1 ].expon to a[ 0 ].expon, the
+// length of the coefficient array of a[ 0 .. n ) in the dense kernels below.
+// Dense operands fill most of their spans, so multiplying them as arrays of
+// coefficients indexed by exponent costs little extra work and needs no
+// exponent to be added, compared or hashed.
+template< typename T >
+size_t denseSpan( const Term< T > *a, size_t n )
+{
+   return static_cast< size_t >( static_cast< long long >( a[ 0 ].expon ) - a[ n - 1 ].expon ) + 1;
+}
+
+// Stores the coefficient of x^( a[ n - 1 ].expon + k ) of a[ 0 .. n ) in
+// coefficients[ k ]; the other coefficients must already be zero.
+template< typename T >
+void scatterTerms( const Term< T > *a, size_t n, T *coefficients )
+{
+   long long lowest = a[ n - 1 ].expon;
+   for( size_t i = 0; i < n; i++ )
+      coefficients[ a[ i ].expon - lowest ] = a[ i ].coef;
+}
+
+// Adds a[ 0 .. n ) * b[ 0 .. m ) to product[ 0 .. n + m - 1 ), all arrays of
+// coefficients indexed by exponent.
+template< typename T >
+void denseMultiply( const T *a, size_t n, const T *b, size_t m, T *product )
+{
+   for( size_t i = 0; i < n; i++ )
+   {
+      const T factor = a[ i ];
+      if( factor == T() )
+         continue;
+
+      T *row = product + i;
+      for( size_t j = 0; j < m; j++ )
+         row[ j ] += factor * b[ j ];
+   }
+}
+
+// Adds the square of a[ 0 .. n ) to product[ 0 .. 2n - 1 ), forming only the
+// pairs i <= j and doubling those with i < j.
+template< typename T >
+void denseSquare( const T *a, size_t n, T *product )
+{
+   for( size_t i = 0; i < n; i++ )
+   {
+      const T factor = a[ i ];
+      if( factor == T() )
+         continue;
+
+      product[ 2 * i ] += factor * factor;
+      const T twice = factor + factor;
+      T *row = product + i;
+      for( size_t j = i + 1; j < n; j++ )
+         row[ j ] += twice * a[ j ];
+   }
+}
+
+// Returns the number of nonzero coefficients[ 0 .. span ).
+template< typename T >
+size_t countNonzero( const T *coefficients, size_t span )
+{
+   size_t count = 0;
+   for( size_t k = 0; k < span; k++ )
+      if( coefficients[ k ] != T() )
+         count++;
+   return count;
+}
+
+// Writes the nonzero coefficients[ k ], k < span, to "terms" as the terms
+// coefficients[ k ] x^( lowest + k ), by decreasing exponent.
+template< typename T >
+void gatherTerms( const T *coefficients, size_t span, long long lowest, Term< T > *terms )
+{
+   for( size_t k = span; k-- > 0; )
+      if( coefficients[ k ] != T() )
+      {
+         terms->coef = coefficients[ k ];
+         terms->expon = static_cast< typename Term< T >::exponent_type >( lowest + static_cast< long long >( k ) );
+         ++terms;
+      }
+}
+
+#endif // MULTIPLY_H
\ No newline at end of file
@@ -0,0 +1,663 @@
+// PackedTerm header
+// Terms packed into one machine word, the coefficient in the high CoefBits
+// bits in two's complement and the exponent, which is never negative in a
+// polynomial, unsigned in the low ExponBits bits.
+// PackedTermVector holds the terms of a Polynomial< PackedTermVector< T >, T >
+// this way: with long long coefficients a term takes 8 bytes instead of 16,
+// which halves the memory every merge reads and writes. The first term that
+// does not fit makes the container switch to full Term< T > storage.
+
+#ifndef PACKEDTERM_H
+#define PACKEDTERM_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+template< typename T >
+struct Term;
+
+// CLASS TEMPLATE PackedTermCodec
+// Packs a coefficient and an exponent of type T into a Word of at least
+// CoefBits + ExponBits bits.
+template< typename T, int CoefBits, int ExponBits >
+struct PackedTermCodec
+{
+   static_assert( std::is_integral< T >::value && std::is_signed< T >::value,
+                  "packed coefficients and exponents are signed integers" );
+   static_assert( CoefBits > 0 && ExponBits > 0 && CoefBits + ExponBits <= 64,
+                  "a packed term takes at most 64 bits" );
+
+   using Word = typename std::conditional< CoefBits + ExponBits <= 32, uint32_t, uint64_t >::type;
+   using SignedWord = typename std::make_signed< Word >::type;
+
+   static const int wordBits = 8 * sizeof( Word );
+   static const int padding = wordBits - CoefBits - ExponBits; // unused high bits
+   static const Word exponMask = ( Word( 1 ) << ExponBits ) - 1;
+
+   // Returns true if "value" is representable in "bits" bits of two's complement
+   static bool fitsIn( T value, int bits )
+   {
+      if( bits >= 8 * static_cast< int >( sizeof( T ) ) )
+         return true;
+
+      long long bound = 1LL << ( bits - 1 );
+      return value >= -bound && value < bound;
+   }
+
+   // Returns true if "value" is representable in "bits" unsigned bits
+   static bool fitsUnsigned( T value, int bits )
+   {
+      if( value < 0 )
+         return false;
+      if( bits >= 8 * static_cast< int >( sizeof( T ) ) - 1 )
+         return true;
+
+      return value < ( 1LL << bits );
+   }
+
+   // Returns true if the term coef x^expon can be packed
+   static bool fits( T coef, T expon )
+   {
+      return fitsIn( coef, CoefBits ) && fitsUnsigned( expon, ExponBits );
+   }
+
+   static Word pack( T coef, T expon )
+   {
+      return static_cast< Word >( static_cast< Word >( coef ) << ExponBits ) |
+             ( static_cast< Word >( expon ) & exponMask );
+   }
+
+   // the arithmetic shift restores the sign
+   static T coefficient( Word word )
+   {
+      return static_cast< T >( static_cast< SignedWord >( static_cast< Word >( word << padding ) ) >>
+                               ( padding + ExponBits ) );
+   }
+
+   static T exponent( Word word )
+   {
+      return static_cast< T >( word & exponMask );
+   }
+};
+
+// The default split: 44 + 20 bits in 64 for 8-byte types, which packs
+// exponents below 2^20, and 16 + 16 bits in 32 for narrower ones
+template< typename T >
+struct DefaultPacking
+{
+   static const int coefBits = sizeof( T ) > 4 ? 44 : 16;
+   static const int exponBits = sizeof( T ) > 4 ? 20 : 16;
+};
+
+// CLASS TEMPLATE PackedTermVector
+// A sequence of Term< T > with the interface of vector that Polynomial uses.
+// Elements are read by value and written through proxy references, so
+// polynomial[ i ].coef = c and it->expon += e pack the new values in place.
+template< typename T,
+          int CoefBits = DefaultPacking< T >::coefBits,
+          int ExponBits = DefaultPacking< T >::exponBits >
+class PackedTermVector
+{
+   using Codec = PackedTermCodec< T, CoefBits, ExponBits >;
+   using Word = typename Codec::Word;
+
+public:
+   using value_type = Term< T >;
+   using size_type = size_t;
+   using difference_type = ptrdiff_t;
+
+   class reference;
+
+   // CLASS CoefReference
+   // The coefficient of an element, as an lvalue of type T
+   class CoefReference
+   {
+   public:
+      CoefReference( PackedTermVector *container, size_type pos )
+         : myContainer( container ),
+           myPos( pos )
+      {
+      }
+
+      operator T() const
+      {
+         return myContainer->coefficient( myPos );
+      }
+
+      CoefReference& operator=( T value )
+      {
+         myContainer->setCoefficient( myPos, value );
+         return *this;
+      }
+
+      CoefReference& operator=( const CoefReference &right )
+      {
+         return *this = static_cast< T >( right );
+      }
+
+      CoefReference& operator+=( T value )
+      {
+         return *this = static_cast< T >( static_cast< T >( *this ) + value );
+      }
+
+      CoefReference& operator-=( T value )
+      {
+         return *this = static_cast< T >( static_cast< T >( *this ) - value );
+      }
+
+      CoefReference& operator*=( T value )
+      {
+         return *this = static_cast< T >( static_cast< T >( *this ) * value );
+      }
+
+      // std::sqrt would be ambiguous among its floating-point overloads
+      friend double sqrt( const CoefReference &coef )
+      {
+         return std::sqrt( static_cast< double >( static_cast< T >( coef ) ) );
+      }
+
+   private:
+      PackedTermVector *myContainer;
+      size_type myPos;
+   }; // end class CoefReference
+
+   // CLASS ExponReference
+   // The exponent of an element, as an lvalue of type T
+   class ExponReference
+   {
+   public:
+      ExponReference( PackedTermVector *container, size_type pos )
+         : myContainer( container ),
+           myPos( pos )
+      {
+      }
+
+      operator T() const
+      {
+         return myContainer->exponent( myPos );
+      }
+
+      ExponReference& operator=( T value )
+      {
+         myContainer->setExponent( myPos, value );
+         return *this;
+      }
+
+      ExponReference& operator=( const ExponReference &right )
+      {
+         return *this = static_cast< T >( right );
+      }
+
+      ExponReference& operator+=( T value )
+      {
+         return *this = static_cast< T >( static_cast< T >( *this ) + value );
+      }
+
+      ExponReference& operator-=( T value )
+      {
+         return *this = static_cast< T >( static_cast< T >( *this ) - value );
+      }
+
+   private:
+      PackedTermVector *myContainer;
+      size_type myPos;
+   }; // end class ExponReference
+
+   // CLASS reference
+   // An element, with its fields as the members coef and expon of a Term
+   class reference
+   {
+   public:
+      reference( PackedTermVector *container, size_type pos )
+         : coef( container, pos ),
+           expon( container, pos ),
+           myContainer( container ),
+           myPos( pos )
+      {
+      }
+
+      operator value_type() const
+      {
+         return myContainer->get( myPos );
+      }
+
+      reference& operator=( const value_type &term )
+      {
+         myContainer->set( myPos, term );
+         return *this;
+      }
+
+      reference& operator=( const reference &right )
+      {
+         return *this = static_cast< value_type >( right );
+      }
+
+      CoefReference coef;
+      ExponReference expon;
+
+   private:
+      PackedTermVector *myContainer;
+      size_type myPos;
+   }; // end class reference
+
+   class const_iterator;
+
+   // CLASS iterator
+   class iterator
+   {
+   public:
+      using value_type = Term< T >;
+      using difference_type = ptrdiff_t;
+      using reference = typename PackedTermVector::reference;
+
+      // What operator-> returns: the proxy of the element, held by value
+      struct pointer
+      {
+         reference element;
+
+         reference* operator->()
+         {
+            return &element;
+         }
+      };
+
+      iterator( PackedTermVector *container = nullptr, size_type pos = 0 )
+         : myContainer( container ),
+           myPos( pos )
+      {
+      }
+
+      reference operator*() const
+      {
+         return reference( myContainer, myPos );
+      }
+
+      pointer operator->() const
+      {
+         return pointer{ reference( myContainer, myPos ) };
+      }
+
+      iterator& operator++() // preincrement
+      {
+         ++myPos;
+         return *this;
+      }
+
+      iterator operator++( int ) // postincrement
+      {
+         iterator old = *this;
+         ++myPos;
+         return old;
+      }
+
+      iterator& operator--() // predecrement
+      {
+         --myPos;
+         return *this;
+      }
+
+      bool operator==( const iterator &right ) const
+      {
+         return myPos == right.myPos;
+      }
+
+      bool operator!=( const iterator &right ) const
+      {
+         return myPos != right.myPos;
+      }
+
+   private:
+      friend class PackedTermVector;
+      friend class const_iterator;
+
+      PackedTermVector *myContainer;
+      size_type myPos;
+   }; // end class iterator
+
+   // CLASS const_iterator
+   class const_iterator
+   {
+   public:
+      using value_type = Term< T >;
+      using difference_type = ptrdiff_t;
+      using reference = value_type;
+
+      // What operator-> returns: a copy of the element
+      struct pointer
+      {
+         value_type element;
+
+         const value_type* operator->() const
+         {
+            return &element;
+         }
+      };
+
+      const_iterator( const PackedTermVector *container = nullptr, size_type pos = 0 )
+         : myContainer( container ),
+           myPos( pos )
+      {
+      }
+
+      const_iterator( const iterator &it )
+         : myContainer( it.myContainer ),
+           myPos( it.myPos )
+      {
+      }
+
+      value_type operator*() const
+      {
+         return myContainer->get( myPos );
+      }
+
+      pointer operator->() const
+      {
+         return pointer{ myContainer->get( myPos ) };
+      }
+
+      const_iterator& operator++() // preincrement
+      {
+         ++myPos;
+         return *this;
+      }
+
+      const_iterator operator++( int ) // postincrement
+      {
+         const_iterator old = *this;
+         ++myPos;
+         return old;
+      }
+
+      const_iterator& operator--() // predecrement
+      {
+         --myPos;
+         return *this;
+      }
+
+      bool operator==( const const_iterator &right ) const
+      {
+         return myPos == right.myPos;
+      }
+
+      bool operator!=( const const_iterator &right ) const
+      {
+         return myPos != right.myPos;
+      }
+
+   private:
+      friend class PackedTermVector;
+
+      const PackedTermVector *myContainer;
+      size_type myPos;
+   }; // end class const_iterator
+
+   // Constructs an empty container, with no elements.
+   PackedTermVector()
+      : words( nullptr ),
+        wide( nullptr ),
+        mySize( 0 ),
+        myCapacity( 0 )
+   {
+   }
+
+   // Constructs a container with "count" elements, each 0 x^0.
+   PackedTermVector( const size_type count )
+      : words( count != 0 ? new Word[ count ]() : nullptr ),
+        wide( nullptr ),
+        mySize( count ),
+        myCapacity( count )
+   {
+   }
+
+   // Constructs a container with a copy of each of the elements in "right",
+   // kept packed if they are packed in "right".
+   PackedTermVector( const PackedTermVector &right )
+      : words( nullptr ),
+        wide( nullptr ),
+        mySize( 0 ),
+        myCapacity( 0 )
+   {
+      *this = right;
+   }
+
+   ~PackedTermVector()
+   {
+      delete[] words;
+      delete[] wide;
+   }
+
+   PackedTermVector& operator=( const PackedTermVector &right )
+   {
+      if( &right != this ) // avoid self-assignment
+      {
+         if( right.mySize > myCapacity || packed() != right.packed() )
+         {
+            delete[] words;
+            delete[] wide;
+            words = nullptr;
+            wide = nullptr;
+            myCapacity = right.mySize;
+            if( right.packed() )
+               words = myCapacity != 0 ? new Word[ myCapacity ]() : nullptr;
+            else
+               wide = new value_type[ myCapacity > 0 ? myCapacity : 1 ]();
+         }
+
+         mySize = right.mySize;
+         for( size_type i = 0; i < mySize; i++ )
+            if( packed() )
+               words[ i ] = right.words[ i ];
+            else
+               wide[ i ] = right.wide[ i ];
+      }
+
+      return *this;
+   }
+
+   // Inserts "val" before "where"; returns its position.
+   iterator insert( const_iterator where, const value_type &val )
+   {
+      size_type pos = where.myPos;
+      if( mySize == myCapacity )
+         reserve( myCapacity <= 1 ? myCapacity + 1 : myCapacity * 3 / 2 );
+
+      for( size_type i = mySize; i > pos; i-- )
+         if( packed() )
+            words[ i ] = words[ i - 1 ];
+         else
+            wide[ i ] = wide[ i - 1 ];
+      mySize++;
+
+      set( pos, val );
+      return iterator( this, pos );
+   }
+
+   // Removes the element at "where"; returns the position that follows it.
+   iterator erase( const_iterator where )
+   {
+      for( size_type i = where.myPos; i + 1 < mySize; i++ )
+         if( packed() )
+            words[ i ] = words[ i + 1 ];
+         else
+            wide[ i ] = wide[ i + 1 ];
+      mySize--;
+
+      return iterator( this, where.myPos );
+   }
+
+   // Removes all elements; the terms are packed again from now on.
+   void clear()
+   {
+      mySize = 0;
+      if( !packed() )
+      {
+         delete[] wide;
+         wide = nullptr;
+         myCapacity = 0;
+      }
+   }
+
+   iterator begin()
+   {
+      return iterator( this, 0 );
+   }
+
+   const_iterator begin() const
+   {
+      return const_iterator( this, 0 );
+   }
+
+   iterator end()
+   {
+      return iterator( this, mySize );
+   }
+
+   const_iterator end() const
+   {
+      return const_iterator( this, mySize );
+   }
+
+   bool empty() const
+   {
+      return mySize == 0;
+   }
+
+   size_type size() const
+   {
+      return mySize;
+   }
+
+   size_type capacity() const
+   {
+      return myCapacity;
+   }
+
+   // Returns true while every term is stored packed.
+   bool packed() const
+   {
+      return wide == nullptr;
+   }
+
+   reference operator[]( const size_type pos )
+   {
+      return reference( this, pos );
+   }
+
+   value_type operator[]( const size_type pos ) const
+   {
+      return get( pos );
+   }
+
+   // Returns the element at "pos".
+   value_type get( size_type pos ) const
+   {
+      if( !packed() )
+         return wide[ pos ];
+
+      value_type term;
+      term.coef = Codec::coefficient( words[ pos ] );
+      term.expon = Codec::exponent( words[ pos ] );
+      return term;
+   }
+
+   // Stores "term" at "pos", giving up packing if it does not fit.
+   void set( size_type pos, const value_type &term )
+   {
+      if( packed() && !Codec::fits( term.coef, term.expon ) )
+         widen();
+
+      if( packed() )
+         words[ pos ] = Codec::pack( term.coef, term.expon );
+      else
+         wide[ pos ] = term;
+   }
+
+private:
+   Word *words;          // the packed terms while packed(), or else nullptr
+   value_type *wide;     // the terms once one has not fit, or else nullptr
+   size_type mySize;
+   size_type myCapacity; // the length of words or wide
+
+   T coefficient( size_type pos ) const
+   {
+      return packed() ? Codec::coefficient( words[ pos ] ) : wide[ pos ].coef;
+   }
+
+   T exponent( size_type pos ) const
+   {
+      return packed() ? Codec::exponent( words[ pos ] ) : wide[ pos ].expon;
+   }
+
+   void setCoefficient( size_type pos, T value )
+   {
+      value_type term = get( pos );
+      term.coef = value;
+      set( pos, term );
+   }
+
+   void setExponent( size_type pos, T value )
+   {
+      value_type term = get( pos );
+      term.expon = value;
+      set( pos, term );
+   }
+
+   // Moves the elements to storage for "capacity" elements
+   void reserve( size_type capacity )
+   {
+      if( packed() )
+      {
+         Word *larger = new Word[ capacity ]();
+         for( size_type i = 0; i < mySize; i++ )
+            larger[ i ] = words[ i ];
+         delete[] words;
+         words = larger;
+      }
+      else
+      {
+         value_type *larger = new value_type[ capacity ]();
+         for( size_type i = 0; i < mySize; i++ )
+            larger[ i ] = wide[ i ];
+         delete[] wide;
+         wide = larger;
+      }
+      myCapacity = capacity;
+   }
+
+   // Unpacks every element into full Term< T > storage
+   void widen()
+   {
+      value_type *terms = new value_type[ myCapacity > 0 ? myCapacity : 1 ]();
+      for( size_type i = 0; i < mySize; i++ )
+         terms[ i ] = get( i );
+
+      delete[] words;
+      words = nullptr;
+      wide = terms;
+   }
+}; // end class template PackedTermVector
+
+// Returns true if both containers hold the same terms, packed or not
+template< typename T, int CoefBits, int ExponBits >
+bool operator==( const PackedTermVector< T, CoefBits, ExponBits > &left,
+                 const PackedTermVector< T, CoefBits, ExponBits > &right )
+{
+   if( left.size() != right.size() )
+      return false;
+
+   for( size_t i = 0; i < left.size(); i++ )
+      if( left.get( i ) != right.get( i ) )
+         return false;
+   return true;
+}
+
+template< typename T, int CoefBits, int ExponBits >
+bool operator!=( const PackedTermVector< T, CoefBits, ExponBits > &left,
+                 const PackedTermVector< T, CoefBits, ExponBits > &right )
+{
+   return !( left == right );
+}
+
+#endif // PACKEDTERM_H
\ No newline at end of file
@@ -0,0 +1,269 @@
+// Parse header
+// Reads polynomials from text in exactly the form operator<< writes them,
+// such as "3x^4 - 2x + 1" or "0", one polynomial per line. Numbers are read
+// with std::from_chars, line ends are found 16 bytes at a time with SSE2,
+// and the terms go into buffers that are reused from line to line, so a
+// polynomial is parsed in one pass with no allocation per term.
+//
+//    polynomial := "0" | [ "-" ] term { ( " + " | " - " ) term }
+//    term       := digits [ "x" [ "^" digits ] ]
+//
+// Exponents must decrease from term to term.
+
+#ifndef PARSE_H
+#define PARSE_H
+
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define PARSE_SSE2
+#endif
+
+#include "ModInt - 1111514 - hw5.h"
+
+template< typename T >
+struct Term;
+
+template< typename T1, typename T2 >
+class Polynomial;
+
+// Where and why parsing stopped
+struct ParseError
+{
+   const char *message; // nullptr if no error occurred
+   size_t line;         // counted from 1
+   size_t column;       // in bytes, counted from 1
+   size_t offset;       // in bytes from the start of the text
+};
+
+// Sets "coef" to the integer with the given sign and magnitude; returns false
+// if it does not fit in T.
+template< typename T >
+bool makeCoefficient( unsigned long long magnitude, bool negative, T &coef )
+{
+   using Unsigned = typename std::make_unsigned< T >::type;
+   unsigned long long largest = static_cast< Unsigned >( std::numeric_limits< T >::max() );
+   if( magnitude > largest + ( negative ? 1 : 0 ) )
+      return false;
+
+   coef = negative ? static_cast< T >( -static_cast< T >( magnitude - 1 ) - 1 ) : static_cast< T >( magnitude );
+   return true;
+}
+
+// Modular coefficients are reduced modulo P.
+template< unsigned long long P >
+bool makeCoefficient( unsigned long long magnitude, bool negative, ModInt< P > &coef )
+{
+   coef = ModInt< P >( static_cast< long long >( magnitude % P ) );
+   if( negative )
+      coef = -coef;
+   return true;
+}
+
+// Returns the first '\n' in [ first, last ), or last if there is none.
+inline const char* findLineEnd( const char *first, const char *last )
+{
+#if defined( PARSE_SSE2 )
+   const __m128i newline = _mm_set1_epi8( '\n' );
+   for( ; last - first >= 16; first += 16 )
+   {
+      __m128i block = _mm_loadu_si128( reinterpret_cast< const __m128i * >( first ) );
+      unsigned int mask = static_cast< unsigned int >( _mm_movemask_epi8( _mm_cmpeq_epi8( block, newline ) ) );
+      if( mask != 0 )
+         return first + std::countr_zero( mask );
+   }
+#endif
+
+   for( ; first != last; ++first )
+      if( *first == '\n' )
+         return first;
+   return last;
+}
+
+// CLASS TEMPLATE PolynomialParser
+// Reads the polynomials of a text, such as a MappedFile, one line at a time.
+// Empty lines are skipped; a '\r' before a line end is ignored.
+template< typename T >
+class PolynomialParser
+{
+public:
+   using exponent_type = typename Term< T >::exponent_type;
+
+   // Reads the text [ first, last ), which must stay valid while it is parsed.
+   PolynomialParser( const char *first, const char *last )
+      : start( first ),
+        current( first ),
+        myLast( last ),
+        lineNumber( 0 ),
+        coefficients( nullptr ),
+        exponents( nullptr ),
+        capacity( 0 ),
+        myError{ nullptr, 0, 0, 0 }
+   {
+   }
+
+   PolynomialParser( const PolynomialParser & ) = delete;
+   PolynomialParser& operator=( const PolynomialParser & ) = delete;
+
+   ~PolynomialParser()
+   {
+      delete[] coefficients;
+      delete[] exponents;
+   }
+
+   // Reads the next polynomial into "polynomial". Returns false at the end of
+   // the text, or on an error, which error() then describes; the rest of the
+   // text is not read after an error.
+   template< typename T1 >
+   bool next( Polynomial< T1, T > &polynomial )
+   {
+      while( current != myLast && myError.message == nullptr )
+      {
+         const char *lineEnd = findLineEnd( current, myLast );
+         const char *lineFirst = current;
+         current = lineEnd != myLast ? lineEnd + 1 : myLast;
+         lineNumber++;
+
+         if( lineEnd != lineFirst && lineEnd[ -1 ] == '\r' )
+            --lineEnd;
+         if( lineEnd == lineFirst )
+            continue;
+
+         size_t numTerms;
+         if( !parseLine( lineFirst, lineEnd, numTerms ) )
+            return false;
+
+         polynomial = Polynomial< T1, T >( numTerms );
+         polynomial.setPolynomial( coefficients, exponents, static_cast< int >( numTerms ) );
+         return true;
+      }
+
+      return false;
+   }
+
+   // Describes the error that stopped next(); message is nullptr if none did.
+   const ParseError& error() const
+   {
+      return myError;
+   }
+
+private:
+   const char *start;         // the beginning of the text
+   const char *current;       // the beginning of the next line
+   const char *myLast;        // the end of the text
+   size_t lineNumber;         // the number of lines read
+   T *coefficients;           // the terms of the line being parsed
+   exponent_type *exponents;
+   size_t capacity;           // the length of coefficients and exponents
+   ParseError myError;
+
+   // Parses the polynomial [ first, last ) into coefficients and exponents
+   bool parseLine( const char *first, const char *last, size_t &numTerms )
+   {
+      numTerms = 0;
+      if( last - first == 1 && *first == '0' )
+         return true;
+
+      const char *p = first;
+      bool negative = false;
+      if( *p == '-' )
+      {
+         negative = true;
+         ++p;
+      }
+
+      for( ;; )
+      {
+         // coefficient
+         unsigned long long magnitude = 0;
+         std::from_chars_result result = std::from_chars( p, last, magnitude );
+         if( result.ec == std::errc::invalid_argument )
+            return fail( first, p, "expected a coefficient" );
+         if( result.ec != std::errc() )
+            return fail( first, p, "coefficient out of range" );
+
+         T coef;
+         if( magnitude == 0 )
+            return fail( first, p, "zero coefficient" );
+         if( !makeCoefficient( magnitude, negative, coef ) )
+            return fail( first, p, "coefficient out of range" );
+         p = result.ptr;
+
+         // exponent
+         exponent_type expon = 0;
+         if( p != last && *p == 'x' )
+         {
+            expon = 1;
+            if( ++p != last && *p == '^' )
+            {
+               ++p;
+               // exponent_type may be signed, but the digits never are
+               result = std::from_chars( p, last, expon );
+               if( result.ec == std::errc::invalid_argument || *p == '-' )
+                  return fail( first, p, "expected an exponent" );
+               if( result.ec != std::errc() )
+                  return fail( first, p, "exponent out of range" );
+               p = result.ptr;
+            }
+         }
+
+         if( numTerms > 0 && !( expon < exponents[ numTerms - 1 ] ) )
+            return fail( first, p, "exponents must decrease" );
+         append( coef, expon, numTerms );
+
+         // separator
+         if( p == last )
+            return true;
+         if( last - p < 4 || p[ 0 ] != ' ' || ( p[ 1 ] != '+' && p[ 1 ] != '-' ) || p[ 2 ] != ' ' )
+            return fail( first, p, "expected \" + \", \" - \" or the end of the line" );
+         negative = p[ 1 ] == '-';
+         p += 3;
+      }
+   }
+
+   // Stores the term coef x^expon as term numTerms, growing the buffers
+   // geometrically, so lines of any length need few allocations in all
+   void append( const T &coef, exponent_type expon, size_t &numTerms )
+   {
+      if( numTerms == capacity )
+      {
+         size_t newCapacity = capacity < 8 ? 16 : 2 * capacity;
+         T *newCoefficients = new T[ newCapacity ];
+         exponent_type *newExponents = new exponent_type[ newCapacity ];
+         for( size_t i = 0; i < numTerms; i++ )
+         {
+            newCoefficients[ i ] = coefficients[ i ];
+            newExponents[ i ] = exponents[ i ];
+         }
+
+         delete[] coefficients;
+         delete[] exponents;
+         coefficients = newCoefficients;
+         exponents = newExponents;
+         capacity = newCapacity;
+      }
+
+      coefficients[ numTerms ] = coef;
+      exponents[ numTerms ] = expon;
+      numTerms++;
+   }
+
+   // Records "message" for the position "where" of the line beginning at
+   // lineFirst, and returns false
+   bool fail( const char *lineFirst, const char *where, const char *message )
+   {
+      myError.message = message;
+      myError.line = lineNumber;
+      myError.column = static_cast< size_t >( where - lineFirst ) + 1;
+      myError.offset = static_cast< size_t >( where - start );
+      return false;
+   }
+}; // end class template PolynomialParser
+
+#endif // PARSE_H
\ No newline at end of file
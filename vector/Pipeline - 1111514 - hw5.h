@@ -0,0 +1,236 @@
+// Pipeline header
+// Computes the square roots of a .dat corpus in three overlapping stages:
+// a reader thread reads blocks of records ahead of time, the calling thread
+// computes their roots on a thread pool, and a writer thread prints them.
+// The stages are connected by bounded queues, so reads and writes proceed
+// while roots are being computed. Printed blocks go back to the reader
+// through a third queue and are read into again, so a run allocates only the
+// few blocks that can be in flight at once, however long the corpus is.
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "vector - 1111514 - hw5.h"
+#include "Batch - 1111514 - hw5.h"
+#include "DatCorpus - 1111514 - hw5.h"
+
+// CLASS TEMPLATE BoundedQueue
+// A first-in first-out queue of at most "capacity" items shared by threads;
+// push() waits while it is full and pop() while it is empty.
+template< typename T >
+class BoundedQueue
+{
+public:
+   explicit BoundedQueue( size_t capacity )
+      : items( new T[ capacity > 0 ? capacity : 1 ] ),
+        myCapacity( capacity > 0 ? capacity : 1 ),
+        first( 0 ),
+        mySize( 0 ),
+        closed( false )
+   {
+   }
+
+   BoundedQueue( const BoundedQueue & ) = delete;
+   BoundedQueue& operator=( const BoundedQueue & ) = delete;
+
+   ~BoundedQueue()
+   {
+      delete[] items;
+   }
+
+   // Appends "item", waiting for room.
+   void push( const T &item )
+   {
+      std::unique_lock< std::mutex > lock( mutex );
+      notFull.wait( lock, [ this ] { return mySize < myCapacity; } );
+      items[ ( first + mySize ) % myCapacity ] = item;
+      mySize++;
+      notEmpty.notify_one();
+   }
+
+   // Removes the oldest item into "item", waiting for one. Returns false once
+   // the queue is closed and empty.
+   bool pop( T &item )
+   {
+      std::unique_lock< std::mutex > lock( mutex );
+      notEmpty.wait( lock, [ this ] { return mySize > 0 || closed; } );
+      if( mySize == 0 )
+         return false;
+
+      item = items[ first ];
+      first = ( first + 1 ) % myCapacity;
+      mySize--;
+      notFull.notify_one();
+      return true;
+   }
+
+   // Marks the end of the items; pop() returns false once the rest are taken.
+   void close()
+   {
+      std::lock_guard< std::mutex > lock( mutex );
+      closed = true;
+      notEmpty.notify_all();
+   }
+
+private:
+   T *items;          // circular buffer of the items
+   size_t myCapacity; // the size of items
+   size_t first;      // the position of the oldest item
+   size_t mySize;     // the number of items
+   bool closed;       // set by close()
+
+   std::mutex mutex;
+   std::condition_variable notFull;  // signals that an item was removed
+   std::condition_variable notEmpty; // signals that an item was added or the queue closed
+}; // end class template BoundedQueue
+
+// Records read together, with their results once computed
+template< typename T, typename PolynomialType >
+struct PipelineBlock
+{
+   explicit PipelineBlock( size_t capacity, size_t recordSize )
+      : data( new T[ capacity * recordSize ] ),
+        numRecords( 0 ),
+        polynomials( new PolynomialType[ capacity ] ),
+        roots( new PolynomialType[ capacity ] ),
+        verified( new bool[ capacity ] ),
+        latencies( new double[ capacity ] )
+   {
+   }
+
+   ~PipelineBlock()
+   {
+      delete[] data;
+      delete[] polynomials;
+      delete[] roots;
+      delete[] verified;
+      delete[] latencies;
+   }
+
+   T *data;                     // the records as read
+   size_t numRecords;           // the number of records in data
+   PolynomialType *polynomials; // the polynomial of every record
+   PolynomialType *roots;       // their square roots
+   bool *verified;              // whether each root passed verification
+   double *latencies;           // microseconds spent on each record
+};
+
+// Reads the .dat corpus "fileName" through the pipeline and writes what the
+// sequential drivers print for every record to "writer". blockSize records are
+// read at a time and at most "depth" blocks wait between two stages; with one
+// block in each stage, 2 * depth + 3 blocks are allocated at most.
+// Returns the totals and timings; numRecords is 0 if the file cannot be read.
+template< typename PolynomialType, typename T, int arraySize >
+BatchReport pipelinedSquareRoots( const char *fileName, PolynomialWriter &writer,
+                                  ThreadPool &pool = ThreadPool::shared(),
+                                  size_t blockSize = 4096, size_t depth = 2 )
+{
+   using Block = PipelineBlock< T, PolynomialType >;
+   const size_t recordLength = 2 * arraySize; // values of type T per record
+
+   BatchReport report = {};
+   std::ifstream inFile( fileName, std::ios::in | std::ios::binary );
+   if( !inFile )
+      return report;
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   const size_t maxBlocks = 2 * depth + 3;
+   BoundedQueue< Block * > loaded( depth );
+   BoundedQueue< Block * > computed( depth );
+   BoundedQueue< Block * > recycled( maxBlocks ); // printed blocks, free to read into
+   vector< double > latencies;
+   bool truncated = false;
+
+   // reader stage
+   std::thread reader( [ & ]
+   {
+      size_t numBlocks = 0; // the number of blocks allocated
+      for( ;; )
+      {
+         // a new block only while fewer than maxBlocks exist; one of them
+         // is always on its way back once they all do
+         Block *block = nullptr;
+         if( numBlocks < maxBlocks )
+         {
+            block = new Block( blockSize, recordLength );
+            numBlocks++;
+         }
+         else
+            recycled.pop( block );
+
+         inFile.read( reinterpret_cast< char * >( block->data ),
+                      static_cast< std::streamsize >( blockSize * recordLength * sizeof( T ) ) );
+         size_t bytes = static_cast< size_t >( inFile.gcount() );
+         block->numRecords = bytes / ( recordLength * sizeof( T ) );
+         if( bytes % ( recordLength * sizeof( T ) ) != 0 )
+            truncated = true;
+
+         if( block->numRecords == 0 )
+         {
+            recycled.push( block );
+            break;
+         }
+
+         loaded.push( block );
+         if( !inFile )
+            break;
+      }
+      loaded.close();
+   } );
+
+   // writer stage
+   std::thread printer( [ & ]
+   {
+      for( Block *block; computed.pop( block ); )
+      {
+         for( size_t j = 0; j < block->numRecords; j++ )
+         {
+            writer << "polynomial: " << block->polynomials[ j ] << '\n';
+            writer << "squareRoot: " << block->roots[ j ] << "\n\n";
+            if( !block->verified[ j ] )
+               report.numErrors++;
+            latencies.insert( latencies.end(), block->latencies[ j ] );
+         }
+         report.numRecords += block->numRecords;
+         recycled.push( block );
+      }
+      writer.flush();
+   } );
+
+   // compute stage
+   for( Block *block; loaded.pop( block ); )
+   {
+      pool.run( block->numRecords, [ block ]( size_t j )
+      {
+         DatRecord< T > record = DatCorpusReader< T, arraySize >::record( block->data + j * recordLength );
+         block->verified[ j ] = squareRootRecord( record, block->polynomials[ j ], block->roots[ j ],
+                                                  block->latencies[ j ] );
+      } );
+      computed.push( block );
+   }
+   computed.close();
+
+   reader.join();
+   printer.join();
+
+   recycled.close();
+   for( Block *block; recycled.pop( block ); )
+      delete block;
+
+   if( truncated )
+      std::cout << fileName << " ends with a partial record, which was ignored\n";
+
+   report.seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+   if( !latencies.empty() )
+      setLatencyPercentiles( report, &latencies.front(), latencies.size() );
+   return report;
+}
+
+#endif // PIPELINE_H
\ No newline at end of file
@@ -3,20 +3,92 @@
 
 #include <cmath>
 using std::sqrt;
+using std::log;
+using std::ceil;
+
+#include <random>
+#include <span>
 
 #include "vector - 1111514 - hw5.h"
+#include "ModInt - 1111514 - hw5.h"
+#include "Multiply - 1111514 - hw5.h"
+#include "Merge - 1111514 - hw5.h"
+#include "SquareRoot - 1111514 - hw5.h"
+#include "Format - 1111514 - hw5.h"
+#include "ScratchArena - 1111514 - hw5.h"
+#include "TermGenerator - 1111514 - hw5.h"
+#include "Dispatch - 1111514 - hw5.h"
+
+// Type of the exponents of Term< T >; it is T itself except for modular
+// coefficients, whose exponents must stay ordinary integers
+template< typename T >
+struct TermExponent
+{
+   using type = T;
+};
+
+template< unsigned long long P >
+struct TermExponent< ModInt< P > >
+{
+   using type = long long;
+};
 
 // Represents a term of a polynomial
 template< typename T >
 struct Term
 {
+   using exponent_type = typename TermExponent< T >::type;
+
+   bool operator==( const Term &right ) const
+   {
+      return coef == right.coef && expon == right.expon;
+   }
+
    bool operator!=( const Term &right ) const
    {
       return coef != right.coef || expon != right.expon;
    }
 
    T coef;
-   T expon;
+   exponent_type expon;
+};
+
+// Divides coefficients by a fixed divisor
+template< typename T >
+class CoefficientDivisor
+{
+public:
+   explicit CoefficientDivisor( const T &divisor )
+      : myDivisor( divisor )
+   {
+   }
+
+   T operator()( const T &dividend ) const
+   {
+      return dividend / myDivisor;
+   }
+
+private:
+   T myDivisor;
+};
+
+// Modular coefficients multiply by the inverse, which is computed only once
+template< unsigned long long P >
+class CoefficientDivisor< ModInt< P > >
+{
+public:
+   explicit CoefficientDivisor( const ModInt< P > &divisor )
+      : myInverse( divisor.inverse() )
+   {
+   }
+
+   ModInt< P > operator()( const ModInt< P > &dividend ) const
+   {
+      return dividend * myInverse;
+   }
+
+private:
+   ModInt< P > myInverse;
 };
 
 // Polynomial class template definition
@@ -25,7 +97,7 @@ class Polynomial
 {
     // Overloaded stream insertion operator
     template< typename T1, typename T2 >
-    friend ostream& operator<<(ostream& output, Polynomial< T1, T2 > a);
+    friend ostream& operator<<(ostream& output, const Polynomial< T1, T2 >& a);
 public:
 
     // Constructs an empty polynomial, with no terms.
@@ -59,7 +131,7 @@ public:
         return polynomial == right.polynomial;
     }
 
-    void setPolynomial(T2 coefficient[], T2 exponent[], int numTerms)
+    void setPolynomial(T2 coefficient[], typename Term< T2 >::exponent_type exponent[], int numTerms)
     {
         for (int i = 0; i < numTerms; i++)
         {
@@ -68,104 +140,62 @@ public:
         }
     }
 
-    // addition assignment operator; Polynomial += Polynomial
-    void operator+=(Polynomial& op2)
+    // Sets the terms from iterators over the coefficients and the exponents,
+    // such as the records of a mapped corpus, without copying them first
+    template< typename CoefIterator, typename ExponIterator >
+    void setPolynomial( CoefIterator coefficient, ExponIterator exponent, int numTerms )
     {
-        // addend+=adder
-        int addendsize = polynomial.size();
-        int addersize = op2.polynomial.size();
-        Polynomial x = *this;
-        // if( adder == 0 )
-        if (op2.zero())
-            return;
-
-        // if( addend == 0 )
-        if (x.zero())
-        {
-            // addend = adder
-            *this = op2;
-            return;
-        }
-
-        // buffer = 0
-        Polynomial buffer;
-
-        // buffer = -adder
-        buffer = -op2;
-
-        // if( addend == -adder )
-        if (buffer == *this)
-        {
-            polynomial.clear();     // addend = 0;
-            return;
-        }
-        Polynomial sum;
-        Polynomial store(1);
-        int i = 0;
-        int j = 0;
-        int k = 0;
-        //cout << addendsize << endl << "," << addersize << endl;
-        while (i < addendsize && j < addersize)
-        {
-            if (polynomial[i].expon == op2.polynomial[j].expon) {
-                if (polynomial[i].coef + op2.polynomial[j].coef == 0) {
-                    i++;
-                    j++;
-                }
-                else {
-                    store.polynomial[0].coef = polynomial[i].coef + op2.polynomial[j].coef;
-                    store.polynomial[0].expon = polynomial[i].expon;
-                    sum.polynomial.insert(sum.polynomial.end(), store.polynomial[0]);
-                    i++;
-                    j++;
-                    k++;
-                }
-            }
-            else if (polynomial[i].expon < op2.polynomial[j].expon) {
-                store.polynomial[0].coef = op2.polynomial[j].coef;
-                store.polynomial[0].expon = op2.polynomial[j].expon;
-                sum.polynomial.insert(sum.polynomial.end(), store.polynomial[0]);
-                j++;
-                k++;
-            }
-            else if (polynomial[i].expon > op2.polynomial[j].expon) {
-                store.polynomial[0].coef = polynomial[i].coef;
-                store.polynomial[0].expon = polynomial[i].expon;
-                sum.polynomial.insert(sum.polynomial.end(), store.polynomial[0]);
-                i++;
-                k++;
-            }
-        }
-
-        while (i < addendsize)
+        for( int i = 0; i < numTerms; i++, ++coefficient, ++exponent )
         {
-            store.polynomial[0].coef = polynomial[i].coef;
-            store.polynomial[0].expon = polynomial[i].expon;
-            sum.polynomial.insert(sum.polynomial.end(), store.polynomial[0]);
-            k++;
-            i++;
+            polynomial[ i ].coef = *coefficient;
+            polynomial[ i ].expon = *exponent;
         }
+    }
 
-        while (j < addersize)
-        {
-            store.polynomial[0].coef = op2.polynomial[j].coef;
-            store.polynomial[0].expon = op2.polynomial[j].expon;
-            sum.polynomial.insert(sum.polynomial.end(), store.polynomial[0]);
-            k++;
-            j++;
-        }
-        *this = sum;
+    // addition assignment operator; Polynomial += Polynomial
+    void operator+=( Polynomial &op2 )
+    {
+        mergeTerms( op2, []( const Term< T2 > &term ) { return term; } );
     }
 
     // subtraction assignment operator; Polynomial -= Polynomial
-    void operator-=(Polynomial& op2)
+    void operator-=( Polynomial &op2 )
     {
-        Polynomial minus = -op2;
-        *this += minus;
+        mergeTerms( op2, []( const Term< T2 > &term )
+        {
+           Term< T2 > minus;
+           minus.coef = -term.coef;
+           minus.expon = term.expon;
+           return minus;
+        } );
     }
 
     // multiplication operator; Polynomial * Polynomial
     Polynomial operator*(Polynomial& op2)
+    {
+        // squaring forms each pair of distinct terms only once
+        if (&op2 == this)
+            return square();
+
+        // the strategy depends on the operands' sizes and shapes
+        const MultiplyThresholds &thresholds = MultiplyDispatcher::thresholds< T1, T2 >();
+        size_t pairs = polynomial.size() * op2.polynomial.size();
+        bool denseOperands = dense(thresholds.denseRatio) && op2.dense(thresholds.denseRatio);
+        switch (MultiplyDispatcher::choose(thresholds, pairs, denseOperands)) {
+        case MultiplyStrategy::Dense:
+            return multiplyDense(op2);
+        case MultiplyStrategy::Parallel:
+            return multiplyParallel(op2);
+        case MultiplyStrategy::Hashed:
+            return multiplyHashed(op2);
+        default:
+            return multiplyRows(op2);
+        }
+    }
+
+    // multiplication by folding rows; Polynomial * Polynomial
+    // Every row of the product, a term of *this times op2, is added to the sum.
+    Polynomial multiplyRows(const Polynomial& op2) const
     {
         // product = 0;
         Polynomial product;
@@ -183,14 +213,262 @@ public:
                 buffer.polynomial.clear();
             }
         }
-        while (product.polynomial[0].coef == 0) {
+        while (!product.zero() && product.polynomial[0].coef == 0) {
             product.polynomial.erase(product.polynomial.begin());
         }
 
         return product;
     }
 
+    // multiplication through a hash table; Polynomial * Polynomial
+    // Products are accumulated by exponent in any order and sorted only once,
+    // which suits sparse operands whose products rarely share an exponent.
+    Polynomial multiplyHashed( const Polynomial &op2 ) const
+    {
+        if( zero() || op2.zero() )
+            return Polynomial();
+
+        const Term< T2 > *a = &polynomial[ 0 ];
+        const Term< T2 > *b = &op2.polynomial[ 0 ];
+        size_t n = polynomial.size();
+        size_t m = op2.polynomial.size();
+        long long highest = static_cast< long long >( a[ 0 ].expon ) + b[ 0 ].expon;
+        long long lowest = static_cast< long long >( a[ n - 1 ].expon ) + b[ m - 1 ].expon;
+
+        ScratchScope scope;
+        TermAccumulator< T2 > accumulator( n * m, lowest, highest, &scope.source() );
+        accumulator.addProducts( a, n, b, m );
+
+        Polynomial product( accumulator.compact() );
+        if( !product.zero() )
+            accumulator.extract( &product.polynomial[ 0 ] );
+
+        return product;
+    }
+
+    // multiplication of dense operands; Polynomial * Polynomial
+    // Both operands are spread into arrays of coefficients indexed by exponent
+    // and convolved, and the nonzero coefficients are gathered back into terms.
+    // The arrays span the operands' exponent ranges, so this suits operands
+    // that fill most of those ranges.
+    Polynomial multiplyDense( const Polynomial &op2 ) const
+    {
+        if( zero() || op2.zero() )
+            return Polynomial();
+
+        ScratchScope scope;
+        const Term< T2 > *a = &polynomial[ 0 ];
+        const Term< T2 > *b = &op2.polynomial[ 0 ];
+        size_t n = polynomial.size();
+        size_t m = op2.polynomial.size();
+        size_t spanA = denseSpan( a, n );
+        size_t spanB = denseSpan( b, m );
+
+        T2 *x = scope.allocate< T2 >( spanA );
+        T2 *y = scope.allocate< T2 >( spanB );
+        T2 *z = scope.allocate< T2 >( spanA + spanB - 1 );
+        scatterTerms( a, n, x );
+        scatterTerms( b, m, y );
+        denseMultiply( x, spanA, y, spanB, z );
+
+        return gather( z, spanA + spanB - 1, static_cast< long long >( a[ n - 1 ].expon ) + b[ m - 1 ].expon );
+    }
+
+    // multiplication on several threads; Polynomial * Polynomial
+    // Every thread of "pool" accumulates a disjoint band of output exponents,
+    // and the bands are concatenated in order.
+    Polynomial multiplyParallel( const Polynomial &op2, ThreadPool &pool = ThreadPool::shared() ) const
+    {
+        Polynomial product;
+        if( zero() || op2.zero() )
+            return product;
+
+        parallelMultiply( &polynomial[ 0 ], polynomial.size(), &op2.polynomial[ 0 ], op2.polynomial.size(),
+                          pool, [ &product ]( size_t count ) -> Term< T2 > *
+        {
+            product = Polynomial( count );
+            return count != 0 ? &product.polynomial[ 0 ] : nullptr;
+        } );
+
+        return product;
+    }
+
+    // Returns the square of the polynomial, i.e., Polynomial * Polynomial with
+    // both operands the same. Only the term pairs i <= j are multiplied and the
+    // products with i < j are doubled, which halves the work of operator*.
+    Polynomial square() const
+    {
+        Polynomial product;
+        if( zero() )
+            return product;
+
+        const Term< T2 > *a = &polynomial[ 0 ];
+        size_t n = polynomial.size();
+        size_t pairs = n * ( n + 1 ) / 2;
+
+        const MultiplyThresholds &thresholds = MultiplyDispatcher::thresholds< T1, T2 >();
+        MultiplyStrategy strategy = MultiplyDispatcher::choose( thresholds, pairs, dense( thresholds.denseRatio ) );
+
+        // a dense polynomial is squared as an array of coefficients
+        if( strategy == MultiplyStrategy::Dense )
+        {
+            ScratchScope scope;
+            size_t span = denseSpan( a, n );
+            T2 *x = scope.allocate< T2 >( span );
+            T2 *z = scope.allocate< T2 >( 2 * span - 1 );
+            scatterTerms( a, n, x );
+            denseSquare( x, span, z );
+            return gather( z, 2 * span - 1, 2 * static_cast< long long >( a[ n - 1 ].expon ) );
+        }
+
+        if( strategy == MultiplyStrategy::Parallel )
+        {
+            parallelSquare( a, n, ThreadPool::shared(), [ &product ]( size_t count ) -> Term< T2 > *
+            {
+                product = Polynomial( count );
+                return count != 0 ? &product.polynomial[ 0 ] : nullptr;
+            } );
+            return product;
+        }
+
+        if( strategy == MultiplyStrategy::Hashed )
+        {
+            ScratchScope scope;
+            TermAccumulator< T2 > accumulator( pairs, 2 * static_cast< long long >( a[ n - 1 ].expon ),
+                                               2 * static_cast< long long >( a[ 0 ].expon ), &scope.source() );
+            for( size_t i = 0; i < n; i++ )
+                accumulator.addSquareRow( a, i, i, n );
+
+            product = Polynomial( accumulator.compact() );
+            if( !product.zero() )
+                accumulator.extract( &product.polynomial[ 0 ] );
+            return product;
+        }
+
+        // fold the rows a[ i ] * a[ i .. n ) as operator* does
+        for( size_t i = 0; i < n; i++ )
+        {
+            Polynomial row( n - i );
+            row.polynomial[ 0 ].coef = a[ i ].coef * a[ i ].coef;
+            row.polynomial[ 0 ].expon = 2 * a[ i ].expon;
+            for( size_t j = i + 1; j < n; j++ )
+            {
+                row.polynomial[ j - i ].coef = a[ i ].coef * a[ j ].coef;
+                row.polynomial[ j - i ].coef += row.polynomial[ j - i ].coef;
+                row.polynomial[ j - i ].expon = a[ i ].expon + a[ j ].expon;
+            }
+            product += row;
+        }
+
+        return product;
+    }
+
+    // Returns a generator of the terms of *this * op2 by decreasing exponent,
+    // computed only as they are read, in O( size() ) memory; see productTerms.
+    // Both polynomials must outlive the generator and stay unchanged meanwhile.
+    TermGenerator< T2 > productTerms( const Polynomial &op2 ) const
+    {
+        return ::productTerms( zero() ? nullptr : &polynomial[ 0 ], polynomial.size(),
+                               op2.zero() ? nullptr : &op2.polynomial[ 0 ], op2.polynomial.size(), false );
+    }
+
+    // Returns a generator of the terms of the square, as productTerms( *this )
+    // would yield them, forming only the pairs on and above the diagonal.
+    TermGenerator< T2 > squareTerms() const
+    {
+        return ::productTerms( zero() ? nullptr : &polynomial[ 0 ], polynomial.size(),
+                               zero() ? nullptr : &polynomial[ 0 ], polynomial.size(), true );
+    }
+
+    // Returns the value of the polynomial at x, where F is a ModInt type;
+    // the coefficients are taken modulo F::modulus.
+    template< typename F >
+    F evaluate( const F &x ) const
+    {
+        F result;
+        for( size_t i = 0; i < polynomial.size(); i++ )
+        {
+            // Horner's rule, stepping over the gaps between exponents
+            if( i > 0 )
+                result *= x.pow( polynomial[ i - 1 ].expon - polynomial[ i ].expon );
+            result += F( polynomial[ i ].coef );
+        }
+
+        if( !zero() )
+            result *= x.pow( polynomial[ polynomial.size() - 1 ].expon );
+
+        return result;
+    }
+
+    // Returns the highest of degrees of polynomial's terms
+    int degree() const
+    {
+        if( polynomial.empty() )
+            return 0;
+        else
+            return polynomial.begin()->expon;
+    }
+
+    // Returns the number of terms
+    size_t size() const
+    {
+        return polynomial.size();
+    }
+
+    // Returns term i, counting from the highest exponent
+    const Term< T2 >& term( size_t i ) const
+    {
+        return polynomial[ i ];
+    }
+
+    // Returns an iterator to the term with the highest exponent
+    typename vector< T1 >::const_iterator begin() const
+    {
+        return polynomial.begin();
+    }
+
+    // Returns an iterator past the term with the lowest exponent
+    typename vector< T1 >::const_iterator end() const
+    {
+        return polynomial.end();
+    }
+
+    // Writes the polynomial as operator<< prints it into [ first, last ),
+    // using std::to_chars and no allocation. Returns the end of the text, or
+    // { last, std::errc::value_too_large } if it does not fit.
+    std::to_chars_result format( char *first, char *last ) const
+    {
+        if( zero() )
+            return appendText( first, last, "0" );
+
+        std::to_chars_result result{ first, std::errc() };
+        for( size_t i = 0; i < polynomial.size() && result.ec == std::errc(); i++ )
+        {
+            const Term< T2 > &term = polynomial[ i ];
+            if( term.coef < 0 || term.coef > 0 )
+            {
+                if( term.coef < 0 )
+                    result = appendText( result.ptr, last, i == 0 ? "-" : " - " );
+                else if( i > 0 )
+                    result = appendText( result.ptr, last, " + " );
+
+                if( result.ec == std::errc() )
+                    result = appendMagnitude( result.ptr, last, term.coef );
+            }
+
+            if( term.expon > 0 && result.ec == std::errc() )
+            {
+                result = appendText( result.ptr, last, term.expon == 1 ? "x" : "x^" );
+                if( term.expon != 1 && result.ec == std::errc() )
+                    result = std::to_chars( result.ptr, last, term.expon );
+            }
+        }
+
+        return result;
+    }
+
     // computes the square root of the current polynomial
+    // (modular coefficients use the modular square root and inverse)
     Polynomial compSquareRoot()
     {
         Polynomial remainder;
@@ -203,26 +481,52 @@ public:
         monomial.polynomial[0].expon = remainder.polynomial[0].expon / 2;
         squareroot += monomial;
         divisor += monomial;
-        buffer = monomial * divisor;
+        buffer = monomial.square();
         remainder -= buffer;
+        // the leading term of divisor is fixed once it has been doubled
+        T2 leading = monomial.polynomial[0].coef;
+        leading *= 2;
+        CoefficientDivisor< T2 > divide(leading);
        
         while (!remainder.zero()) {
             divisor.polynomial[divisor.polynomial.size()-1].coef *= 2;
-            monomial.polynomial[0].coef = remainder.polynomial[0].coef / divisor.polynomial[0].coef;
+            monomial.polynomial[0].coef = divide(remainder.polynomial[0].coef);
             monomial.polynomial[0].expon = remainder.polynomial[0].expon - divisor.polynomial[0].expon;
             squareroot += monomial;
             divisor += monomial;
-            buffer = monomial * divisor;
-            remainder -= buffer;
+            remainder.subtractProduct( monomial.polynomial[ 0 ], divisor );
         }
         return squareroot;
     }
 
+    // computes the square roots of in[ i ] into out[ i ], taking the steps of
+    // compSquareRoot with one set of scratch buffers for the whole batch;
+    // succeeded[ i ], if given, tells whether in[ i ] is a perfect square, and
+    // the roots of the others are left zero. Returns the number of perfect squares.
+    static size_t batchSquareRoot( std::span< const Polynomial > in, std::span< Polynomial > out,
+                                   std::span< bool > succeeded = {} )
+    {
+        SquareRootWorkspace< T2 > workspace;
+        size_t numSquares = 0;
+        for( size_t i = 0; i < in.size(); i++ )
+        {
+            const Term< T2 > *a = in[ i ].zero() ? nullptr : &in[ i ].polynomial[ 0 ];
+            bool perfect = workspace.squareRoot( a, in[ i ].polynomial.size() );
+            out[ i ].assign( workspace.root(), workspace.rootSize() );
+            if( !succeeded.empty() )
+               succeeded[ i ] = perfect;
+            if( perfect )
+               numSquares++;
+        }
+
+        return numSquares;
+    }
+
 private:
    vector< T1 > polynomial; // a polynomial
 
    // Attaches a new term to the polynomial
-   void attach( T2 coefficient, T2 exponent )
+   void attach( T2 coefficient, typename Term< T2 >::exponent_type exponent )
    {
       Term< T2 > tempTerm;
       tempTerm.coef = coefficient;
@@ -230,6 +534,50 @@ private:
       polynomial.insert( polynomial.end(), tempTerm );
    }
 
+   // Sets the terms to terms[ 0 .. count ), overwriting the current ones in place
+   void assign( const Term< T2 > *terms, size_t count )
+   {
+      size_t i = 0;
+      for( typename vector< T1 >::iterator it = polynomial.begin(); i < count && it != polynomial.end(); ++it )
+         *it = terms[ i++ ];
+
+      for( ; i < count; i++ )
+         polynomial.insert( polynomial.end(), terms[ i ] );
+
+      while( polynomial.size() > count )
+      {
+         typename vector< T1 >::iterator last = polynomial.end();
+         polynomial.erase( --last );
+      }
+   }
+
+   // Adds transform( t ) for every term t of op2. Both term lists are merged
+   // into scratch memory by mergeTermArrays, and only the sum is copied back
+   // into the polynomial, so no temporary polynomial is allocated. transform
+   // must keep the order of the exponents.
+   template< typename Transform >
+   void mergeTerms( const Polynomial &op2, Transform transform )
+   {
+      ScratchScope scope;
+      const Term< T2 > *a = zero() ? nullptr : &polynomial[ 0 ];
+      const Term< T2 > *b = op2.zero() ? nullptr : &op2.polynomial[ 0 ];
+      Term< T2 > *sum = scope.allocate< Term< T2 > >( polynomial.size() + op2.polynomial.size() );
+      size_t k = mergeTermArrays( a, polynomial.size(), b, op2.polynomial.size(), sum, transform );
+      assign( sum, k );
+   }
+
+   // Subtracts term * op2 without forming the product; the step of compSquareRoot
+   void subtractProduct( const Term< T2 > &term, const Polynomial &op2 )
+   {
+      mergeTerms( op2, [ &term ]( const Term< T2 > &right )
+      {
+         Term< T2 > product;
+         product.coef = -( term.coef * right.coef );
+         product.expon = term.expon + right.expon;
+         return product;
+      } );
+   }
+
    // Returns the minus of the current polynomial
    Polynomial operator-()
    {
@@ -245,65 +593,108 @@ private:
       return minus;
    }
 
-   // Returns true if and only if polynomial is a zero polynomial
-   bool zero() const
+   // Returns true if the terms fill at least 1 / ratio of the exponents from
+   // the lowest to the highest
+   bool dense( size_t ratio ) const
    {
-      return polynomial.empty();
+      return !zero() && polynomial.size() * ratio >= denseSpan( &polynomial[ 0 ], polynomial.size() );
    }
 
-   // Returns the highest of degrees of polynomial's terms
-   int degree() const
+   // Returns the polynomial with the terms coefficients[ k ] x^( lowest + k ),
+   // k < span, whose coefficients are nonzero
+   static Polynomial gather( const T2 *coefficients, size_t span, long long lowest )
    {
-      if( polynomial.empty() )
-         return 0;
-      else
-         return polynomial.begin()->expon;
+      Polynomial product( countNonzero( coefficients, span ) );
+      if( !product.zero() )
+         gatherTerms( coefficients, span, lowest, &product.polynomial[ 0 ] );
+      return product;
+   }
+
+   // Returns true if and only if polynomial is a zero polynomial
+   bool zero() const
+   {
+      return polynomial.empty();
    }
 
 }; // end class template Polynomial
 
 // Overloaded stream insertion operator
 template< typename T1, typename T2 >
-ostream& operator<<( ostream &output, Polynomial< T1, T2 > a )
+ostream& operator<<( ostream &output, const Polynomial< T1, T2 > &a )
 {
-   if( a.zero() )
+   // render into a stack buffer when the polynomial is short enough
+   const size_t bufferSize = 512;
+   char buffer[ bufferSize ];
+   std::to_chars_result result = a.format( buffer, buffer + bufferSize );
+   if( result.ec == std::errc() )
+      output.write( buffer, result.ptr - buffer );
+   else
    {
-      output << 0 << endl;
-      return output;
+      PolynomialWriter writer( output, 2 * bufferSize );
+      writer << a;
    }
 
-   typename vector< T1 >::iterator it = a.polynomial.begin();
+   return output; // enables cout << x << y;
+} // end function operator<<
+
+// How verifySquare checks a square root
+enum class Verification
+{
+   Probabilistic, // compare values at random points modulo a large prime
+   Exact          // compare the terms of root * root with the polynomial's
+};
 
-   if( it->coef < 0 )
-      cout << "-" << -it->coef;
-   else if( it->coef > 0 )
-      cout << it->coef;
+// Field in which verifySquare evaluates polynomials with coefficients of type T
+template< typename T >
+struct EvaluationField
+{
+   using type = ModInt<>;
+};
 
-   if( it->expon > 0 )
+template< unsigned long long P >
+struct EvaluationField< ModInt< P > >
+{
+   using type = ModInt< P >;
+};
+
+// Returns true if root * root == poly.
+// Probabilistic verification evaluates both sides at random points x modulo a
+// prime P. If root * root != poly, their difference has degree d and vanishes
+// at most at d of the P points (Schwartz-Zippel), so each point wrongly
+// agrees with probability at most d / P. Enough points are drawn to bring the
+// probability of accepting a wrong root below errorBound. A difference whose
+// coefficients are all multiples of P cannot be detected.
+template< typename T1, typename T2 >
+bool verifySquare( const Polynomial< T1, T2 > &root, const Polynomial< T1, T2 > &poly,
+                   Verification mode = Verification::Probabilistic, double errorBound = 1e-30 )
+{
+   // the square is formed term by term and abandoned at the first difference
+   if( mode == Verification::Exact )
    {
-      if( it->expon == 1 )
-         cout << "x";
-      else
-         cout << "x^" << it->expon;
+      typename vector< T1 >::const_iterator it = poly.begin();
+      for( const Term< T2 > &term : root.squareTerms() )
+         if( it == poly.end() || term != *it++ )
+            return false;
+      return it == poly.end();
    }
 
-   for( ++it; it != a.polynomial.end(); ++it )
-   {
-      if( it->coef < 0 )
-         cout << " - " << -it->coef;
-      else if( it->coef > 0 )
-         cout << " + " << it->coef;
+   using F = typename EvaluationField< T2 >::type;
 
-      if( it->expon > 0 )
-      {
-         if( it->expon == 1 )
-            cout << "x";
-         else
-            cout << "x^" << it->expon;
-      }
+   double degree = 2.0 * root.degree() > poly.degree() ? 2.0 * root.degree() : poly.degree();
+   int numPoints = 1;
+   if( degree > 0 && errorBound > 0 && errorBound < 1 )
+      numPoints = static_cast< int >( ceil( log( errorBound ) / log( degree / F::modulus ) ) );
+
+   static thread_local std::mt19937_64 engine( std::random_device{}() );
+   for( int i = 0; i < numPoints; i++ )
+   {
+      F x = static_cast< long long >( engine() % F::modulus );
+      F value = root.evaluate( x );
+      if( value * value != poly.evaluate( x ) )
+         return false;
    }
 
-   return output; // enables cout << x << y;
-} // end function operator<<
+   return true;
+}
 
 #endif
\ No newline at end of file
@@ -0,0 +1,214 @@
+// ScratchArena header
+// Per-thread bump allocator for the intermediate buffers of polynomial
+// operations. Memory is handed out by advancing a pointer and taken back all
+// at once when the ScratchScope that covers the operation ends, so temporary
+// term buffers cost no calls to the global allocator once the arena has grown
+// to the size an operation needs.
+
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// CLASS ScratchArena
+// A list of chunks, each at least twice as large as the one before. When the
+// outermost scope of a thread ends, the first chunks, up to keptBytes in all,
+// are kept for the next operation and the rest are freed, so one large
+// product does not leave its peak memory with the thread for good.
+class ScratchArena
+{
+public:
+   // A position in the arena, returned by mark() and taken by release()
+   struct Mark
+   {
+      size_t chunk; // the index of the current chunk
+      size_t used;  // the bytes used in it
+   };
+
+   ScratchArena()
+      : numChunks( 0 ),
+        current( 0 ),
+        used( 0 ),
+        depth( 0 )
+   {
+   }
+
+   ScratchArena( const ScratchArena & ) = delete;
+   ScratchArena& operator=( const ScratchArena & ) = delete;
+
+   ~ScratchArena()
+   {
+      for( size_t i = 0; i < numChunks; i++ )
+         delete[] chunks[ i ].data;
+   }
+
+   // Returns the arena of the calling thread.
+   static ScratchArena& local()
+   {
+      static thread_local ScratchArena arena;
+      return arena;
+   }
+
+   // Returns room for "count" value-initialized objects of type T, valid until
+   // the arena is released to a mark taken before this call.
+   template< typename T >
+   T* allocate( size_t count )
+   {
+      static_assert( std::is_trivially_destructible< T >::value,
+                     "objects in a scratch arena are never destroyed" );
+
+      T *first = static_cast< T * >( allocateBytes( count * sizeof( T ), alignof( T ) ) );
+      for( size_t i = 0; i < count; i++ )
+         new( first + i ) T();
+      return first;
+   }
+
+   // Returns the current position.
+   Mark mark() const
+   {
+      return Mark{ current, used };
+   }
+
+   // Frees everything allocated since "position" was taken.
+   void release( const Mark &position )
+   {
+      current = position.chunk;
+      used = position.used;
+   }
+
+   // Called as a scope begins; returns the position it must go back to.
+   Mark enter()
+   {
+      depth++;
+      return mark();
+   }
+
+   // Called as a scope ends with the position enter() returned. Once no scope
+   // is left, the chunks beyond keptBytes are freed.
+   void leave( const Mark &position )
+   {
+      release( position );
+      if( --depth == 0 )
+         trim();
+   }
+
+private:
+   struct Chunk
+   {
+      char *data;  // the memory of the chunk
+      size_t size; // its size in bytes
+   };
+
+   static const size_t maxChunks = 48;     // sizes double, so this is never reached
+   static const size_t firstChunk = 1 << 16;
+   static const size_t keptBytes = 1 << 20; // kept between operations, beside the first chunk
+
+   Chunk chunks[ maxChunks ]; // chunks[ 0 .. numChunks ) are allocated
+   size_t numChunks;
+   size_t current;            // the chunk allocations come from
+   size_t used;               // the bytes of chunks[ current ] in use
+   size_t depth;              // the number of scopes open on the arena
+
+   // Frees the chunks after the first that would take the arena past
+   // keptBytes; the current chunk and those before it are always kept.
+   void trim()
+   {
+      size_t total = numChunks > 0 ? chunks[ 0 ].size : 0;
+      size_t kept = numChunks > 0 ? 1 : 0;
+      while( kept < numChunks && ( kept <= current || total + chunks[ kept ].size <= keptBytes ) )
+         total += chunks[ kept++ ].size;
+
+      for( size_t i = kept; i < numChunks; i++ )
+         delete[] chunks[ i ].data;
+      numChunks = kept;
+   }
+
+   // Returns "bytes" bytes aligned to "alignment", moving to a later chunk,
+   // or adding one, if the current chunk is full.
+   void* allocateBytes( size_t bytes, size_t alignment )
+   {
+      if( bytes == 0 )
+         bytes = 1;
+
+      for( ;; )
+      {
+         if( current < numChunks )
+         {
+            size_t offset = ( used + alignment - 1 ) / alignment * alignment;
+            if( offset + bytes <= chunks[ current ].size )
+            {
+               used = offset + bytes;
+               return chunks[ current ].data + offset;
+            }
+
+            if( current + 1 < numChunks && chunks[ current + 1 ].size >= bytes + alignment )
+            {
+               current++;
+               used = 0;
+               continue;
+            }
+         }
+
+         // the later chunks are too small; replace them with one that fits
+         size_t next = current < numChunks ? current + 1 : numChunks;
+         size_t size = next > 0 ? 2 * chunks[ next - 1 ].size : firstChunk;
+         while( size < bytes + alignment )
+            size *= 2;
+
+         for( size_t i = next; i < numChunks; i++ )
+            delete[] chunks[ i ].data;
+
+         if( next >= maxChunks )
+            throw std::bad_alloc();
+
+         chunks[ next ].data = new char[ size ];
+         chunks[ next ].size = size;
+         numChunks = next + 1;
+         current = next;
+         used = 0;
+      }
+   }
+}; // end class ScratchArena
+
+// CLASS ScratchScope
+// Takes scratch memory from the calling thread's arena and gives all of it
+// back when the scope ends. Scopes nest, so an operation may call others that
+// use scratch memory of their own.
+class ScratchScope
+{
+public:
+   ScratchScope()
+      : arena( ScratchArena::local() ),
+        start( arena.enter() )
+   {
+   }
+
+   ScratchScope( const ScratchScope & ) = delete;
+   ScratchScope& operator=( const ScratchScope & ) = delete;
+
+   ~ScratchScope()
+   {
+      arena.leave( start );
+   }
+
+   // Returns room for "count" value-initialized objects of type T.
+   template< typename T >
+   T* allocate( size_t count )
+   {
+      return arena.allocate< T >( count );
+   }
+
+   // Returns the arena the scope takes memory from.
+   ScratchArena& source()
+   {
+      return arena;
+   }
+
+private:
+   ScratchArena &arena;      // the calling thread's arena
+   ScratchArena::Mark start; // where the scope began
+}; // end class ScratchScope
+
+#endif // SCRATCHARENA_H
\ No newline at end of file
@@ -0,0 +1,204 @@
+// SquareRoot header
+// Square roots of polynomials over arrays of terms sorted by decreasing
+// exponent, taking the steps of compSquareRoot: every step divides the
+// leading term of the remainder by twice the root's leading term and
+// subtracts the new term times the doubled root so far. A workspace keeps
+// the remainder, the doubled root and the root between calls, so a batch of
+// square roots allocates only when a polynomial needs more room than all
+// those before it.
+
+#ifndef SQUAREROOT_H
+#define SQUAREROOT_H
+
+#include <cmath>
+#include <cstddef>
+
+#include "ModInt - 1111514 - hw5.h"
+#include "Merge - 1111514 - hw5.h"
+
+template< typename T >
+struct Term;
+
+template< typename T >
+class CoefficientDivisor;
+
+// Returns true if "coef" may be the square of a coefficient; whether it is
+// one is checked once the root is taken.
+template< typename T >
+bool hasSquareRoot( const T &coef )
+{
+   return !( coef < T() );
+}
+
+// Modular coefficients are squares if they are quadratic residues (Euler's
+// criterion); sqrt would exit on any other.
+template< unsigned long long P >
+bool hasSquareRoot( const ModInt< P > &coef )
+{
+   return coef == ModInt< P >() || coef.pow( ( P - 1 ) / 2 ) == 1;
+}
+
+// CLASS TEMPLATE SquareRootWorkspace
+template< typename T >
+class SquareRootWorkspace
+{
+public:
+   using exponent_type = typename Term< T >::exponent_type;
+
+   SquareRootWorkspace()
+      : remainder( nullptr ),
+        next( nullptr ),
+        divisor( nullptr ),
+        myRoot( nullptr ),
+        remainderCapacity( 0 ),
+        nextCapacity( 0 ),
+        divisorCapacity( 0 ),
+        rootCapacity( 0 ),
+        myRootSize( 0 )
+   {
+   }
+
+   SquareRootWorkspace( const SquareRootWorkspace & ) = delete;
+   SquareRootWorkspace& operator=( const SquareRootWorkspace & ) = delete;
+
+   ~SquareRootWorkspace()
+   {
+      delete[] remainder;
+      delete[] next;
+      delete[] divisor;
+      delete[] myRoot;
+   }
+
+   // Computes the square root of a[ 0 .. n ), which root() then returns.
+   // Returns false, leaving no root, if a[ 0 .. n ) is not a perfect square;
+   // compSquareRoot gives no answer for such polynomials.
+   bool squareRoot( const Term< T > *a, size_t n )
+   {
+      using std::sqrt;
+
+      myRootSize = 0;
+      if( n == 0 )
+         return true;
+      if( !hasSquareRoot( a[ 0 ].coef ) || a[ 0 ].expon % 2 != 0 )
+         return false;
+
+      reserve( remainder, remainderCapacity, n, 0 );
+      for( size_t i = 0; i < n; i++ )
+         remainder[ i ] = a[ i ];
+      size_t remainderSize = n;
+
+      // the exponents of the root cannot be below half the lowest of a
+      exponent_type lowest = a[ n - 1 ].expon / 2;
+
+      Term< T > monomial;
+      monomial.coef = static_cast< T >( sqrt( a[ 0 ].coef ) );
+      monomial.expon = a[ 0 ].expon / 2;
+      if( monomial.coef * monomial.coef != a[ 0 ].coef )
+         return false;
+
+      append( monomial );
+      remainderSize = subtractProduct( monomial, remainderSize );
+
+      // the leading term of divisor is fixed once it has been doubled
+      T leading = monomial.coef;
+      leading *= 2;
+      CoefficientDivisor< T > divide( leading );
+
+      while( remainderSize > 0 )
+      {
+         divisor[ myRootSize - 1 ].coef *= 2;
+         monomial.coef = divide( remainder[ 0 ].coef );
+         monomial.expon = remainder[ 0 ].expon - divisor[ 0 ].expon;
+
+         // the leading term of the remainder must cancel exactly, or the
+         // remainder would never shrink
+         if( monomial.coef * leading != remainder[ 0 ].coef || monomial.expon < lowest )
+         {
+            myRootSize = 0;
+            return false;
+         }
+
+         append( monomial );
+         remainderSize = subtractProduct( monomial, remainderSize );
+      }
+
+      return true;
+   }
+
+   // Returns the root found by the last squareRoot, by decreasing exponent
+   const Term< T >* root() const
+   {
+      return myRoot;
+   }
+
+   // Returns the number of terms of root()
+   size_t rootSize() const
+   {
+      return myRootSize;
+   }
+
+private:
+   Term< T > *remainder;      // what is left to take the root of
+   Term< T > *next;           // the next remainder, while it is merged
+   Term< T > *divisor;        // twice the root, but for its newest term
+   Term< T > *myRoot;         // the root so far; divisor has the same size
+   size_t remainderCapacity;
+   size_t nextCapacity;
+   size_t divisorCapacity;
+   size_t rootCapacity;
+   size_t myRootSize;
+
+   // Makes room for "count" terms in "buffer", keeping its first "keep" terms
+   static void reserve( Term< T > *&buffer, size_t &capacity, size_t count, size_t keep )
+   {
+      if( count <= capacity )
+         return;
+
+      size_t newCapacity = capacity < 8 ? 16 : 2 * capacity;
+      if( newCapacity < count )
+         newCapacity = count;
+
+      Term< T > *newBuffer = new Term< T >[ newCapacity ];
+      for( size_t i = 0; i < keep; i++ )
+         newBuffer[ i ] = buffer[ i ];
+
+      delete[] buffer;
+      buffer = newBuffer;
+      capacity = newCapacity;
+   }
+
+   // Attaches "monomial" to the root and to the divisor
+   void append( const Term< T > &monomial )
+   {
+      reserve( divisor, divisorCapacity, myRootSize + 1, myRootSize );
+      reserve( myRoot, rootCapacity, myRootSize + 1, myRootSize );
+      divisor[ myRootSize ] = monomial;
+      myRoot[ myRootSize ] = monomial;
+      myRootSize++;
+   }
+
+   // Subtracts monomial * divisor from the remainder of "remainderSize"
+   // terms; returns the size of the new remainder
+   size_t subtractProduct( const Term< T > &monomial, size_t remainderSize )
+   {
+      reserve( next, nextCapacity, remainderSize + myRootSize, 0 );
+      size_t size = mergeTermArrays( remainder, remainderSize, divisor, myRootSize, next,
+                                     [ &monomial ]( const Term< T > &right )
+      {
+         Term< T > product;
+         product.coef = -( monomial.coef * right.coef );
+         product.expon = monomial.expon + right.expon;
+         return product;
+      } );
+
+      Term< T > *swap = remainder;
+      remainder = next;
+      next = swap;
+      size_t swapCapacity = remainderCapacity;
+      remainderCapacity = nextCapacity;
+      nextCapacity = swapCapacity;
+      return size;
+   }
+}; // end class template SquareRootWorkspace
+
+#endif // SQUAREROOT_H
\ No newline at end of file
@@ -0,0 +1,261 @@
+// TermGenerator header
+// Lazy multiplication: a C++20 coroutine merges the rows of a product with a
+// heap and yields the product's terms by decreasing exponent, one at a time,
+// so a consumer that stops early pays only for the terms it has read.
+
+#ifndef TERMGENERATOR_H
+#define TERMGENERATOR_H
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+template< typename T >
+struct Term;
+
+// CLASS TEMPLATE TermGenerator
+// The coroutine type of productTerms; an input range of Term< T >.
+template< typename T >
+class TermGenerator
+{
+public:
+   struct promise_type
+   {
+      Term< T > current;                  // the term yielded last
+      std::exception_ptr exception;       // thrown by the coroutine body
+
+      TermGenerator get_return_object()
+      {
+         return TermGenerator( std::coroutine_handle< promise_type >::from_promise( *this ) );
+      }
+
+      std::suspend_always initial_suspend() noexcept
+      {
+         return {};
+      }
+
+      std::suspend_always final_suspend() noexcept
+      {
+         return {};
+      }
+
+      std::suspend_always yield_value( const Term< T > &term )
+      {
+         current = term;
+         return {};
+      }
+
+      void return_void()
+      {
+      }
+
+      void unhandled_exception()
+      {
+         exception = std::current_exception();
+      }
+   };
+
+   // CLASS iterator
+   // Resumes the coroutine for every increment.
+   class iterator
+   {
+   public:
+      using value_type = Term< T >;
+      using difference_type = ptrdiff_t;
+      using iterator_category = std::input_iterator_tag;
+
+      iterator()
+         : coroutine( nullptr )
+      {
+      }
+
+      explicit iterator( std::coroutine_handle< promise_type > handle )
+         : coroutine( handle )
+      {
+      }
+
+      const Term< T >& operator*() const
+      {
+         return coroutine.promise().current;
+      }
+
+      const Term< T >* operator->() const
+      {
+         return &coroutine.promise().current;
+      }
+
+      iterator& operator++() // preincrement
+      {
+         advance( coroutine );
+         return *this;
+      }
+
+      void operator++( int ) // postincrement
+      {
+         ++*this;
+      }
+
+      bool operator==( std::default_sentinel_t ) const
+      {
+         return coroutine == nullptr || coroutine.done();
+      }
+
+   private:
+      std::coroutine_handle< promise_type > coroutine; // the generator's coroutine
+   }; // end class iterator
+
+   TermGenerator( TermGenerator &&right ) noexcept
+      : coroutine( std::exchange( right.coroutine, nullptr ) )
+   {
+   }
+
+   TermGenerator& operator=( TermGenerator &&right ) noexcept
+   {
+      if( &right != this )
+      {
+         if( coroutine )
+            coroutine.destroy();
+         coroutine = std::exchange( right.coroutine, nullptr );
+      }
+      return *this;
+   }
+
+   // Destroys the coroutine, wherever it was suspended.
+   ~TermGenerator()
+   {
+      if( coroutine )
+         coroutine.destroy();
+   }
+
+   // Computes the first term. May be called only once.
+   iterator begin()
+   {
+      advance( coroutine );
+      return iterator( coroutine );
+   }
+
+   std::default_sentinel_t end() const
+   {
+      return std::default_sentinel;
+   }
+
+   // Stores the next term in "term"; returns false when there are no more.
+   bool next( Term< T > &term )
+   {
+      advance( coroutine );
+      if( coroutine.done() )
+         return false;
+
+      term = coroutine.promise().current;
+      return true;
+   }
+
+private:
+   std::coroutine_handle< promise_type > coroutine; // the suspended computation
+
+   explicit TermGenerator( std::coroutine_handle< promise_type > handle )
+      : coroutine( handle )
+   {
+   }
+
+   // Runs the coroutine to its next term, rethrowing what it threw.
+   static void advance( std::coroutine_handle< promise_type > handle )
+   {
+      if( handle.done() )
+         return;
+
+      handle.resume();
+      if( handle.promise().exception )
+         std::rethrow_exception( handle.promise().exception );
+   }
+}; // end class template TermGenerator
+
+// Yields the terms of a[ 0 .. n ) * b[ 0 .. m ) by decreasing exponent,
+// skipping exponents whose coefficients cancel; if "symmetric", b is a and
+// the square is formed from the pairs on and above the diagonal.
+// Row i of the product, a[ i ] times b, has decreasing exponents, so the
+// rows are merged with a max-heap holding the next product of every row;
+// a row enters the heap only when the row above has yielded its first
+// product, since it cannot have a larger exponent before then.
+// a and b must stay valid and unchanged while the generator is used.
+template< typename T >
+TermGenerator< T > productTerms( const Term< T > *a, size_t n, const Term< T > *b, size_t m, bool symmetric )
+{
+   if( n == 0 || m == 0 )
+      co_return;
+
+   struct Entry
+   {
+      long long expon; // a[ i ].expon + b[ j ].expon
+      size_t i;
+      size_t j;
+
+      bool operator<( const Entry &right ) const
+      {
+         return expon < right.expon;
+      }
+   };
+
+   // held by the coroutine frame, so it is freed even if the consumer stops early
+   std::unique_ptr< Entry[] > heap( new Entry[ n ] );
+   size_t size = 0;
+
+   // the first product of row i
+   auto pushRow = [ & ]( size_t i )
+   {
+      size_t j = symmetric ? i : 0;
+      heap[ size++ ] = Entry{ static_cast< long long >( a[ i ].expon ) + b[ j ].expon, i, j };
+      std::push_heap( heap.get(), heap.get() + size );
+   };
+
+   pushRow( 0 );
+   while( size > 0 )
+   {
+      long long expon = heap[ 0 ].expon;
+      T coef = T();
+      while( size > 0 && heap[ 0 ].expon == expon )
+      {
+         std::pop_heap( heap.get(), heap.get() + size );
+         Entry top = heap[ --size ];
+
+         T product = a[ top.i ].coef * b[ top.j ].coef;
+         if( symmetric && top.j != top.i )
+            product += product;
+         coef += product;
+
+         if( top.j == ( symmetric ? top.i : 0 ) && top.i + 1 < n )
+            pushRow( top.i + 1 );
+
+         if( top.j + 1 < m )
+         {
+            heap[ size++ ] = Entry{ static_cast< long long >( a[ top.i ].expon ) + b[ top.j + 1 ].expon,
+                                    top.i, top.j + 1 };
+            std::push_heap( heap.get(), heap.get() + size );
+         }
+      }
+
+      if( coef != T() )
+      {
+         Term< T > term;
+         term.coef = coef;
+         term.expon = static_cast< typename Term< T >::exponent_type >( expon );
+         co_yield term;
+      }
+   }
+}
+
+// As productTerms, over arrays that the generator owns and frees with its
+// coroutine; b is ignored if "symmetric"
+template< typename T >
+TermGenerator< T > ownedProductTerms( std::unique_ptr< Term< T >[] > a, size_t n,
+                                      std::unique_ptr< Term< T >[] > b, size_t m, bool symmetric )
+{
+   for( const Term< T > &term : productTerms( a.get(), n, symmetric ? a.get() : b.get(), m, symmetric ) )
+      co_yield term;
+}
+
+#endif // TERMGENERATOR_H
\ No newline at end of file
@@ -0,0 +1,236 @@
+// ThreadPool header
+// A fixed set of worker threads that is created once and reused,
+// so that parallel operations do not pay for thread creation.
+// Each task's indices are dealt out as one contiguous range per thread;
+// a thread that runs out steals the upper half of another thread's range.
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// CLASS ThreadPool
+class ThreadPool
+{
+public:
+   // Constructs a pool with "numWorkers" threads besides the caller;
+   // by default one less than the number of hardware threads.
+   explicit ThreadPool( size_t numWorkers = defaultWorkers() )
+      : workers( numWorkers > 0 ? new std::thread[ numWorkers ] : nullptr ),
+        numWorkers( numWorkers ),
+        ranges( new Range[ numWorkers + 1 ] ),
+        active( 0 ),
+        generation( 0 ),
+        stopping( false )
+   {
+      for( size_t i = 0; i < numWorkers; i++ )
+         workers[ i ] = std::thread( &ThreadPool::work, this, i + 1 );
+   }
+
+   ThreadPool( const ThreadPool & ) = delete;
+   ThreadPool& operator=( const ThreadPool & ) = delete;
+
+   // Stops and joins all worker threads.
+   ~ThreadPool()
+   {
+      {
+         std::lock_guard< std::mutex > lock( mutex );
+         stopping = true;
+      }
+      wake.notify_all();
+
+      for( size_t i = 0; i < numWorkers; i++ )
+         workers[ i ].join();
+      delete[] workers;
+      delete[] ranges;
+   }
+
+   // Returns the number of threads that run tasks, including the caller.
+   size_t size() const
+   {
+      return numWorkers + 1;
+   }
+
+   // Runs task( i ) for every i in [ 0, count ) on the workers and the calling
+   // thread, and returns when all of them have finished. Calls from different
+   // threads take turns, since the workers serve one task at a time; a call
+   // made from inside a task runs serially on the calling thread, so parallel
+   // kernels may be used within tasks.
+   void run( size_t count, const std::function< void( size_t ) > &task )
+   {
+      if( insideTask() || numWorkers == 0 )
+      {
+         for( size_t i = 0; i < count; i++ )
+            task( i );
+         return;
+      }
+
+      // held for the whole task: myTask, myFirst, ranges and active are shared
+      std::lock_guard< std::mutex > turn( runMutex );
+
+      // ranges hold 32-bit indices
+      const size_t largest = 0xFFFFFFFF;
+      for( size_t first = 0; first < count; first += largest )
+      {
+         size_t chunk = count - first < largest ? count - first : largest;
+         {
+            std::lock_guard< std::mutex > lock( mutex );
+            myTask = &task;
+            myFirst = first;
+            deal( chunk );
+            active = numWorkers;
+            generation++;
+         }
+         wake.notify_all();
+
+         execute( 0 );
+
+         std::unique_lock< std::mutex > lock( mutex );
+         finished.wait( lock, [ this ] { return active == 0; } );
+         myTask = nullptr;
+      }
+   }
+
+   // Returns true on a thread that is running a task of some pool, where
+   // run() does not use the workers.
+   static bool calledFromTask()
+   {
+      return insideTask();
+   }
+
+   // Returns the pool shared by the whole program, created on first use.
+   static ThreadPool& shared()
+   {
+      static ThreadPool pool;
+      return pool;
+   }
+
+private:
+   // The unclaimed indices [ begin, end ) of one thread, packed as
+   // begin << 32 | end so that they are claimed and split atomically;
+   // each range has a cache line of its own.
+   struct alignas( 64 ) Range
+   {
+      std::atomic< unsigned long long > bounds{ 0 };
+   };
+
+   std::thread *workers; // the worker threads
+   size_t numWorkers;    // the number of worker threads
+   Range *ranges;        // one per thread; the caller's is ranges[ 0 ]
+
+   std::mutex runMutex;              // held by the thread whose task is running
+   std::mutex mutex;
+   std::condition_variable wake;     // signals a new task or stop
+   std::condition_variable finished; // signals that all workers are idle
+
+   const std::function< void( size_t ) > *myTask = nullptr; // the current task
+   size_t myFirst = 0;             // the index that range index 0 stands for
+   size_t active;                  // workers still busy with the current task
+   unsigned long long generation;  // incremented for every task
+   bool stopping;                  // set by the destructor
+
+   static size_t defaultWorkers()
+   {
+      unsigned int threads = std::thread::hardware_concurrency();
+      return threads > 1 ? threads - 1 : 0;
+   }
+
+   // Returns true on a thread that is running a task of some pool.
+   static bool& insideTask()
+   {
+      static thread_local bool inside = false;
+      return inside;
+   }
+
+   static unsigned long long pack( unsigned long long begin, unsigned long long end )
+   {
+      return begin << 32 | end;
+   }
+
+   // Gives every thread an equal share of [ 0, count ).
+   void deal( size_t count )
+   {
+      size_t numThreads = numWorkers + 1;
+      for( size_t k = 0; k < numThreads; k++ )
+         ranges[ k ].bounds.store( pack( count * k / numThreads, count * ( k + 1 ) / numThreads ),
+                                   std::memory_order_relaxed );
+   }
+
+   // Claims the next index of thread "self": the front of its own range, or,
+   // once that is empty, the front of the upper half stolen from another
+   // thread, whose remainder becomes the new range of "self".
+   // Returns false when no thread has indices left.
+   bool claim( size_t self, size_t &index )
+   {
+      std::atomic< unsigned long long > &own = ranges[ self ].bounds;
+      unsigned long long bounds = own.load( std::memory_order_acquire );
+      while( ( bounds >> 32 ) < ( bounds & 0xFFFFFFFF ) )
+         if( own.compare_exchange_weak( bounds, bounds + ( 1ULL << 32 ), std::memory_order_acq_rel ) )
+         {
+            index = static_cast< size_t >( bounds >> 32 );
+            return true;
+         }
+
+      size_t numThreads = numWorkers + 1;
+      for( size_t k = 1; k < numThreads; k++ )
+      {
+         std::atomic< unsigned long long > &victim = ranges[ ( self + k ) % numThreads ].bounds;
+         unsigned long long theirs = victim.load( std::memory_order_acquire );
+         for( ;; )
+         {
+            unsigned long long begin = theirs >> 32;
+            unsigned long long end = theirs & 0xFFFFFFFF;
+            if( begin >= end )
+               break;
+
+            unsigned long long middle = begin + ( end - begin ) / 2;
+            if( victim.compare_exchange_weak( theirs, pack( begin, middle ), std::memory_order_acq_rel ) )
+            {
+               own.store( pack( middle + 1, end ), std::memory_order_release );
+               index = static_cast< size_t >( middle );
+               return true;
+            }
+         }
+      }
+
+      return false;
+   }
+
+   // Claims indices of the current task for thread "self" until none are left.
+   void execute( size_t self )
+   {
+      insideTask() = true;
+      for( size_t i; claim( self, i ); )
+         ( *myTask )( myFirst + i );
+      insideTask() = false;
+   }
+
+   // Body of worker thread "self".
+   void work( size_t self )
+   {
+      unsigned long long seen = 0;
+      for( ;; )
+      {
+         {
+            std::unique_lock< std::mutex > lock( mutex );
+            wake.wait( lock, [ & ] { return stopping || generation != seen; } );
+            if( stopping )
+               return;
+            seen = generation;
+         }
+
+         execute( self );
+
+         std::lock_guard< std::mutex > lock( mutex );
+         if( --active == 0 )
+            finished.notify_one();
+      }
+   }
+}; // end class ThreadPool
+
+#endif // THREADPOOL_H
\ No newline at end of file